@@ -0,0 +1,122 @@
+#ifndef PRSEEDCANDIDATE_H
+#define PRSEEDCANDIDATE_H 1
+
+// Include files
+#include "PrSeedingHitStore.h"
+
+/** @class PrSeedCandidate PrSeedCandidate.h
+ *  Track candidate of the seeding. Same parametrisation as PrSeedTrack, but the hits
+ *  are indices into the PrSeedingHitStore of the event, so that the fit reads
+ *  contiguous arrays. Converted into a PrSeedTrack only when making the LHCb::Tracks.
+ */
+class PrSeedCandidate {
+public:
+  PrSeedCandidate( unsigned int zone, float zRef,
+                   const PrHitIndices::allocator_type& alloc = PrHitIndices::allocator_type() )
+    : m_zone( zone ), m_zRef( zRef ), m_hits( alloc ) {
+    init();
+  }
+
+  /// The hits are copied into the allocator of hits, i.e. the same arena
+  PrSeedCandidate( unsigned int zone, float zRef, const PrHitIndices& hits )
+    : m_zone( zone ), m_zRef( zRef ), m_hits( hits ) {
+    initParameters();
+  }
+
+  void init() {
+    m_hits.clear();
+    initParameters();
+  }
+
+  void initParameters() {
+    m_valid = true;
+    m_ax = 0.;
+    m_bx = 0.;
+    m_cx = 0.;
+    m_ay = 0.;
+    m_by = 0.;
+    m_chi2 = 0.;
+    m_nDoF = -1;
+  }
+
+  PrHitIndices& hits()             { return m_hits; }
+  const PrHitIndices& hits() const { return m_hits; }
+  void addHit( unsigned int hit )  { m_hits.push_back( hit ); }
+
+  unsigned int zone() const { return m_zone; }
+  float zRef()        const { return m_zRef; }
+
+  float ax() const { return m_ax; }
+  float bx() const { return m_bx; }
+  float cx() const { return m_cx; }
+  float ay() const { return m_ay; }
+  float by() const { return m_by; }
+
+  float x( float z )      const { float dz = z - m_zRef; return m_ax + dz * ( m_bx + dz * m_cx ); }
+  float xSlope( float z ) const { float dz = z - m_zRef; return m_bx + 2 * dz * m_cx; }
+  float y( float z )      const { return m_ay + ( z - m_zRef ) * m_by; }
+  float ySlope()          const { return m_by; }
+
+  void updateParameters( float dax, float dbx, float dcx, float day = 0., float dby = 0. ) {
+    m_ax += dax;
+    m_bx += dbx;
+    m_cx += dcx;
+    m_ay += day;
+    m_by += dby;
+  }
+
+  void setParameters( float ax, float bx, float cx, float ay, float by ) {
+    m_ax = ax;
+    m_bx = bx;
+    m_cx = cx;
+    m_ay = ay;
+    m_by = by;
+  }
+
+  /// Distance in x between the hit, at the y of the track, and the track
+  float distance( const PrSeedingHitStore& store, unsigned int hit ) const {
+    const float yTrack = y( store.z( hit ) );
+    return ( store.x( hit ) + yTrack * store.dxDy( hit ) ) - x( store.z( hit ) + yTrack * store.dzDy( hit ) );
+  }
+
+  float deltaY( const PrSeedingHitStore& store, unsigned int hit ) const {
+    if ( 0 == store.dxDy( hit ) ) return 0.;
+    return distance( store, hit ) / store.dxDy( hit );
+  }
+
+  float chi2( const PrSeedingHitStore& store, unsigned int hit ) const {
+    const float d = distance( store, hit );
+    return d * d * store.w( hit );
+  }
+
+  bool valid() const           { return m_valid; }
+  void setValid( bool valid )  { m_valid = valid; }
+
+  void setChi2( float chi2, int nDoF ) { m_chi2 = chi2; m_nDoF = nDoF; }
+  float chi2()       const { return m_chi2; }
+  float chi2PerDoF() const { return m_chi2 / m_nDoF; }
+  int   nDoF()       const { return m_nDoF; }
+
+  struct GreaterBySize {
+    bool operator() ( const PrSeedCandidate& lhs, const PrSeedCandidate& rhs ) const {
+      return lhs.hits().size() > rhs.hits().size();
+    }
+  };
+
+private:
+  unsigned int m_zone;
+  float        m_zRef;
+  PrHitIndices m_hits;
+  bool         m_valid;
+  float        m_ax;
+  float        m_bx;
+  float        m_cx;
+  float        m_ay;
+  float        m_by;
+  float        m_chi2;
+  int          m_nDoF;
+};
+
+typedef std::vector<PrSeedCandidate> PrSeedCandidates;
+
+#endif // PRSEEDCANDIDATE_H
@@ -0,0 +1,132 @@
+#ifndef PRSEEDINGARENA_H
+#define PRSEEDINGARENA_H 1
+
+// Include files
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+/** @class PrSeedingArena PrSeedingArena.h
+ *  Event-scoped bump allocator for the scratch containers of the seeding.
+ *  Memory is handed out linearly from large blocks and only given back by reset(),
+ *  at the start of the next event; only the most recent allocation can be returned
+ *  earlier. If an event needed more than one block, reset() replaces them by a single
+ *  block of the total size, so that in steady state an event does not call malloc at
+ *  all; nMallocs() counts the calls of the current event.
+ *
+ *  Containers use it through PrSeedingArena::Allocator. A default constructed
+ *  Allocator has no arena and falls back to the heap.
+ */
+class PrSeedingArena {
+public:
+  explicit PrSeedingArena( std::size_t blockSize = 256 * 1024 )
+    : m_blockSize( blockSize ), m_ptr( nullptr ), m_end( nullptr ), m_nMallocs( 0 ) {}
+
+  ~PrSeedingArena() { release(); }
+
+  PrSeedingArena( const PrSeedingArena& ) = delete;
+  PrSeedingArena& operator=( const PrSeedingArena& ) = delete;
+
+  void* allocate( std::size_t bytes, std::size_t align ) {
+    char* p = alignUp( m_ptr, align );
+    if ( nullptr == m_ptr || p + bytes > m_end ) {
+      addBlock( bytes + align > m_blockSize ? bytes + align : m_blockSize );
+      p = alignUp( m_ptr, align );
+    }
+    m_ptr = p + bytes;
+    return p;
+  }
+
+  /// Only the most recent allocation can be given back before reset()
+  void deallocate( void* p, std::size_t bytes ) {
+    if ( static_cast<char*>( p ) + bytes == m_ptr ) m_ptr = static_cast<char*>( p );
+  }
+
+  /// Give back everything allocated since the last reset. Invalidates all containers using the arena.
+  void reset() {
+    if ( 1 < m_blocks.size() ) {
+      const std::size_t total = capacity();
+      release();
+      addBlock( total );
+    } else if ( !m_blocks.empty() ) {
+      m_ptr = m_blocks.front().first;
+      m_end = m_ptr + m_blocks.front().second;
+    }
+    // -- The malloc of the merged block is not one of the next event
+    m_nMallocs = 0;
+  }
+
+  /// Number of malloc calls done by the arena since the last reset
+  unsigned int nMallocs() const { return m_nMallocs; }
+
+  /// Total size of the blocks currently owned
+  std::size_t capacity() const {
+    std::size_t total = 0;
+    for ( std::vector<Block>::const_iterator itB = m_blocks.begin(); m_blocks.end() != itB; ++itB ) total += (*itB).second;
+    return total;
+  }
+
+  /// STL allocator drawing from a PrSeedingArena
+  template <typename T>
+  class Allocator {
+  public:
+    typedef T value_type;
+    template <typename U> struct rebind { typedef Allocator<U> other; };
+
+    Allocator( PrSeedingArena* arena = nullptr ) : m_arena( arena ) {}
+    template <typename U> Allocator( const Allocator<U>& other ) : m_arena( other.arena() ) {}
+
+    T* allocate( std::size_t n ) {
+      if ( nullptr == m_arena ) return static_cast<T*>( ::operator new( n * sizeof( T ) ) );
+      return static_cast<T*>( m_arena->allocate( n * sizeof( T ), alignof( T ) ) );
+    }
+    void deallocate( T* p, std::size_t n ) {
+      if ( nullptr == m_arena ) {
+        ::operator delete( p );
+      } else {
+        m_arena->deallocate( p, n * sizeof( T ) );
+      }
+    }
+
+    PrSeedingArena* arena() const { return m_arena; }
+
+    template <typename U> bool operator==( const Allocator<U>& other ) const { return m_arena == other.arena(); }
+    template <typename U> bool operator!=( const Allocator<U>& other ) const { return m_arena != other.arena(); }
+
+  private:
+    PrSeedingArena* m_arena;
+  };
+
+private:
+  typedef std::pair<char*, std::size_t> Block;
+
+  static char* alignUp( char* p, std::size_t align ) {
+    const std::size_t mis = reinterpret_cast<std::size_t>( p ) % align;
+    return 0 == mis ? p : p + ( align - mis );
+  }
+
+  void addBlock( std::size_t size ) {
+    char* mem = static_cast<char*>( std::malloc( size ) );
+    if ( nullptr == mem ) throw std::bad_alloc();
+    ++m_nMallocs;
+    m_blocks.push_back( Block( mem, size ) );
+    m_ptr = mem;
+    m_end = mem + size;
+  }
+
+  void release() {
+    for ( std::vector<Block>::const_iterator itB = m_blocks.begin(); m_blocks.end() != itB; ++itB ) std::free( (*itB).first );
+    m_blocks.clear();
+    m_ptr = nullptr;
+    m_end = nullptr;
+  }
+
+  std::size_t        m_blockSize;
+  std::vector<Block> m_blocks;
+  char*              m_ptr;
+  char*              m_end;
+  unsigned int       m_nMallocs;
+};
+#endif // PRSEEDINGARENA_H
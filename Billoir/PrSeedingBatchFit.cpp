@@ -0,0 +1,435 @@
+// Include files
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// local
+#include "PrSeedingBatchFit.h"
+
+//-----------------------------------------------------------------------------
+// Implementation file for class : PrSeedingBatchFit
+//
+// The kernel is written with the GCC vector extensions, for W lanes, and compiled once
+// per instruction set of PrSeedingSimd. The operations are done in the same order as in
+// the scalar fitTrack, so that without FMA contraction both give the same parameters.
+//-----------------------------------------------------------------------------
+
+// The helpers taking or returning vectors are always inlined in a function of their
+// instruction set, their ABI outside of it does not matter
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace {
+
+  template <typename V, typename T>
+  PRSEEDING_KERNEL V load( const T* p ) {
+    V v;
+    std::memcpy( &v, p, sizeof( v ) );
+    return v;
+  }
+
+  template <typename V, typename T>
+  PRSEEDING_KERNEL void store( T* p, const V& v ) {
+    std::memcpy( p, &v, sizeof( v ) );
+  }
+
+  template <typename I>
+  PRSEEDING_KERNEL bool any( const I& mask, int nLanes ) {
+    for ( int l = 0; nLanes > l; ++l ) {
+      if ( 0 != mask[l] ) return true;
+    }
+    return false;
+  }
+
+  /// Same as PrSeedCandidate::distance
+  template <typename F>
+  PRSEEDING_KERNEL F distance( const F& x, const F& z, const F& dxDy, const F& dzDy,
+                               const F& ax, const F& bx, const F& cx, const F& ay, const F& by, float zRef ) {
+    const F yTrack = ay + ( z - zRef ) * by;
+    const F dz     = ( z + yTrack * dzDy ) - zRef;
+    return ( x + yTrack * dxDy ) - ( ax + dz * ( bx + dz * cx ) );
+  }
+
+  /// Smallest float t such that, for a float d, d < t is the same as d < 1e-9 in double
+  float minDenominator() {
+    float t = 1e-9f;
+    if ( t < 1e-9 ) t = std::nextafter( t, 1.f );
+    return t;
+  }
+
+  /// Fit the W lanes starting at lane l0 of the block
+  template <unsigned int W>
+  PRSEEDING_KERNEL void fitLanes( PrSeedingBatchFit::Block& b, unsigned int l0, float zRef, float maxChi2InTrack ) {
+    typedef typename PrSeedingSimd::Lanes<W>::F F;
+    typedef typename PrSeedingSimd::Lanes<W>::I I;
+    const unsigned int stride = PrSeedingBatchFit::blockSize;
+    static const float minDen = minDenominator();
+    const F zero = F{};
+
+    F ax = load<F>( b.ax + l0 );
+    F bx = load<F>( b.bx + l0 );
+    F cx = load<F>( b.cx + l0 );
+    F ay = load<F>( b.ay + l0 );
+    F by = load<F>( b.by + l0 );
+    I active = load<I>( b.used + l0 );
+    I ok     = I{};
+    I worst  = I{};
+
+    for ( int loop = 0; 3 > loop; ++loop ) {
+      if ( !any( active, W ) ) break;
+      F s0   = zero;
+      F sz   = zero;
+      F sz2  = zero;
+      F sz3  = zero;
+      F sz4  = zero;
+      F sd   = zero;
+      F sdz  = zero;
+      F sdz2 = zero;
+
+      F t0  = zero;
+      F tz  = zero;
+      F tz2 = zero;
+      F td  = zero;
+      F tdz = zero;
+
+      for ( unsigned int j = 0; b.nHits > j; ++j ) {
+        const unsigned int k = j * stride + l0;
+        const F x    = load<F>( &b.x[k] );
+        const F zh   = load<F>( &b.z[k] );
+        const F w    = load<F>( &b.w[k] );
+        const F dxDy = load<F>( &b.dxDy[k] );
+        const F dzDy = load<F>( &b.dzDy[k] );
+        const I stereo = dxDy != 0.f;
+
+        // -- The first iteration uses the x hits only, the others add the stereo hits to the fit in y
+        const F ws = ( 0 == loop ) ? ( stereo ? zero : w ) : w;
+        const F wt = ( 0 == loop ) ? zero : ( stereo ? w : zero );
+
+        const F z  = zh - zRef;
+        const F d  = distance( x, zh, dxDy, dzDy, ax, bx, cx, ay, by, zRef );
+        const F dy = d / ( stereo ? dxDy : zero + 1.f );
+        t0   += wt;
+        tz   += wt * z;
+        tz2  += wt * z * z;
+        td   += wt * dy;
+        tdz  += wt * dy * z;
+
+        s0   += ws;
+        sz   += ws * z;
+        sz2  += ws * z * z;
+        sz3  += ws * z * z * z;
+        sz4  += ws * z * z * z * z;
+        sd   += ws * d;
+        sdz  += ws * d * z;
+        sdz2 += ws * d * z * z;
+      }
+      const F b1 = sz  * sz  - s0  * sz2;
+      const F c1 = sz2 * sz  - s0  * sz3;
+      const F d1 = sd  * sz  - s0  * sdz;
+      const F b2 = sz2 * sz2 - sz * sz3;
+      const F c2 = sz3 * sz2 - sz * sz4;
+      const F d2 = sdz * sz2 - sz * sdz2;
+
+      // -- All lanes divide, the ones whose result is not used divide by 1: fitTrack does not
+      //    divide there, and 0/0 would raise FE_INVALID. Padding lanes have s0 = 0 and are bad.
+      const F den = b1 * c2 - b2 * c1;
+      const I bad = ( den < 0.f ? -den : den ) < minDen;
+      const F divDen = bad ? zero + 1.f : den;
+      const F divS0  = bad ? zero + 1.f : s0;
+      const F db  = ( d1 * c2 - d2 * c1 ) / divDen;
+      const F dc  = ( d2 * b1 - d1 * b2 ) / divDen;
+      const F da  = ( sd - db * sz - dc * sz2 ) / divS0;
+
+      const I hasT = t0 > 0.f;
+      const F deny = tz * tz - t0 * tz2;
+      const F divDeny = hasT ? deny : zero + 1.f;
+      const F day  = hasT ? -( tdz * tz - td * tz2 ) / divDeny : zero;
+      const F dby  = hasT ? -( td  * tz - t0 * tdz ) / divDeny : zero;
+
+      // -- A lane with a singular system stops there, and has failed
+      const I fitted = active & ~bad;
+      active = fitted;
+      ax = fitted ? ax + da  : ax;
+      bx = fitted ? bx + db  : bx;
+      cx = fitted ? cx + dc  : cx;
+      ay = fitted ? ay + day : ay;
+      by = fitted ? by + dby : by;
+
+      F maxChi2 = zero;
+      worst = I{};
+      for ( unsigned int j = 0; b.nHits > j; ++j ) {
+        const unsigned int k = j * stride + l0;
+        const F d = distance( load<F>( &b.x[k] ), load<F>( &b.z[k] ), load<F>( &b.dxDy[k] ), load<F>( &b.dzDy[k] ),
+                              ax, bx, cx, ay, by, zRef );
+        const F chi2 = d * d * load<F>( &b.w[k] );
+        const I larger = chi2 > maxChi2;
+        maxChi2 = larger ? chi2 : maxChi2;
+        worst   = larger ? I{} + (int)j : worst;
+      }
+      const I good = fitted & ( zero + maxChi2InTrack > maxChi2 );
+      ok     |= good;
+      active &= ~good;
+    }
+
+    store( b.ax + l0, ax );
+    store( b.bx + l0, bx );
+    store( b.cx + l0, cx );
+    store( b.ay + l0, ay );
+    store( b.by + l0, by );
+    store( b.ok + l0, ok );
+    store( b.worst + l0, worst );
+  }
+
+  /// Fit the first n lanes of the block, W at a time
+  template <unsigned int W>
+  PRSEEDING_KERNEL void fitBlock( PrSeedingBatchFit::Block& b, unsigned int n, float zRef, float maxChi2InTrack ) {
+    for ( unsigned int l0 = 0; n > l0; l0 += W ) fitLanes<W>( b, l0, zRef, maxChi2InTrack );
+  }
+
+  PRSEEDING_NO_CONTRACT
+  void fitBlockScalar( PrSeedingBatchFit::Block& b, unsigned int n, float zRef, float maxChi2InTrack ) {
+    fitBlock<1>( b, n, zRef, maxChi2InTrack );
+  }
+
+  PRSEEDING_TARGET( "sse4.2" )
+  void fitBlockSSE42( PrSeedingBatchFit::Block& b, unsigned int n, float zRef, float maxChi2InTrack ) {
+    fitBlock<4>( b, n, zRef, maxChi2InTrack );
+  }
+
+  PRSEEDING_TARGET( "avx2" )
+  void fitBlockAVX2( PrSeedingBatchFit::Block& b, unsigned int n, float zRef, float maxChi2InTrack ) {
+    fitBlock<8>( b, n, zRef, maxChi2InTrack );
+  }
+
+  PRSEEDING_TARGET( "avx512f" )
+  void fitBlockAVX512( PrSeedingBatchFit::Block& b, unsigned int n, float zRef, float maxChi2InTrack ) {
+    fitBlock<16>( b, n, zRef, maxChi2InTrack );
+  }
+}
+
+//=========================================================================
+//  Choose the kernel
+//=========================================================================
+PrSeedingBatchFit::FitBlock PrSeedingBatchFit::kernel( PrSeedingSimd::Level level ) {
+  switch ( level ) {
+  case PrSeedingSimd::SSE42:  return fitBlockSSE42;
+  case PrSeedingSimd::AVX2:   return fitBlockAVX2;
+  case PrSeedingSimd::AVX512: return fitBlockAVX512;
+  default:                    return fitBlockScalar;
+  }
+}
+
+void PrSeedingBatchFit::setLevel( PrSeedingSimd::Level level ) {
+  m_lanes    = PrSeedingSimd::lanes( level );
+  m_fitBlock = kernel( level );
+}
+
+//=========================================================================
+//  Fit the tracks, by blocks of blockSize
+//=========================================================================
+void PrSeedingBatchFit::fit( const PrSeedingHitStore& store, float zRef, float maxChi2InTrack,
+                             PrSeedCandidate* tracks, unsigned int nTracks ) {
+  m_ok.assign( nTracks, 0 );
+  m_worst.assign( nTracks, 0 );
+  if ( 0 == nTracks ) return;
+
+  for ( unsigned int first = 0; nTracks > first; first += blockSize ) {
+    const unsigned int n = std::min( nTracks - first, (unsigned int)blockSize );
+    // -- The kernel reads the lanes by groups of m_lanes
+    const unsigned int nLanes = ( n + m_lanes - 1 ) / m_lanes * m_lanes;
+
+    unsigned int nHits = 0;
+    for ( unsigned int l = 0; n > l; ++l ) nHits = std::max( nHits, (unsigned int)tracks[first+l].hits().size() );
+
+    m_block.nHits = nHits;
+    if ( m_block.x.size() < nHits * blockSize ) {
+      m_block.x.resize(    nHits * blockSize );
+      m_block.z.resize(    nHits * blockSize );
+      m_block.w.resize(    nHits * blockSize );
+      m_block.dxDy.resize( nHits * blockSize );
+      m_block.dzDy.resize( nHits * blockSize );
+    }
+
+    for ( unsigned int l = 0; nLanes > l; ++l ) {
+      // -- Padding hits have zero weight and do not contribute
+      const unsigned int nTrackHits = n > l ? tracks[first+l].hits().size() : 0;
+      for ( unsigned int k = nTrackHits * blockSize + l; nHits * blockSize > k; k += blockSize ) {
+        m_block.x[k]    = 0.f;
+        m_block.z[k]    = 0.f;
+        m_block.w[k]    = 0.f;
+        m_block.dxDy[k] = 0.f;
+        m_block.dzDy[k] = 0.f;
+      }
+      m_block.used[l] = 0;
+      m_block.ok[l]   = 0;
+      m_block.worst[l] = 0;
+      m_block.ax[l]   = 0.f;
+      m_block.bx[l]   = 0.f;
+      m_block.cx[l]   = 0.f;
+      m_block.ay[l]   = 0.f;
+      m_block.by[l]   = 0.f;
+    }
+    for ( unsigned int l = 0; n > l; ++l ) {
+      const PrSeedCandidate& track = tracks[first+l];
+      m_block.used[l] = -1;
+      m_block.ax[l]   = track.ax();
+      m_block.bx[l]   = track.bx();
+      m_block.cx[l]   = track.cx();
+      m_block.ay[l]   = track.ay();
+      m_block.by[l]   = track.by();
+      unsigned int k = l;
+      for ( PrHitIndices::const_iterator itH = track.hits().begin(); track.hits().end() != itH; ++itH, k += blockSize ) {
+        m_block.x[k]    = store.x( *itH );
+        m_block.z[k]    = store.z( *itH );
+        m_block.w[k]    = store.w( *itH );
+        m_block.dxDy[k] = store.dxDy( *itH );
+        m_block.dzDy[k] = store.dzDy( *itH );
+      }
+    }
+
+    m_fitBlock( m_block, n, zRef, maxChi2InTrack );
+
+    for ( unsigned int l = 0; n > l; ++l ) {
+      tracks[first+l].setParameters( m_block.ax[l], m_block.bx[l], m_block.cx[l], m_block.ay[l], m_block.by[l] );
+      m_ok[first+l] = 0 != m_block.ok[l];
+      m_worst[first+l] = m_block.worst[l];
+    }
+  }
+}
+
+//=========================================================================
+//  Scalar fit of one track, return OK if fit sucecssfull
+//=========================================================================
+PRSEEDING_NO_CONTRACT
+bool PrSeedingBatchFit::fitTrack( const PrSeedingHitStore& hitStore, float zRef, float maxChi2InTrack,
+                                  PrSeedCandidate& track, unsigned int& worst ) {
+  return fitMoments( hitStore, zRef, maxChi2InTrack, track, MomentsOf<float>( hitStore, zRef, track ), worst );
+}
+
+//=========================================================================
+//  Scalar fit of one track with the moments kept by the caller
+//=========================================================================
+bool PrSeedingBatchFit::fitTrack( const PrSeedingHitStore& hitStore, float zRef, float maxChi2InTrack,
+                                  PrSeedCandidate& track, const Moments& moments, unsigned int& worst ) {
+  return fitMoments( hitStore, zRef, maxChi2InTrack, track, moments, worst );
+}
+
+//=========================================================================
+//  Fit from the moments of the hits, return OK if fit sucecssfull
+//=========================================================================
+template <typename T>
+PRSEEDING_NO_CONTRACT
+bool PrSeedingBatchFit::fitMoments( const PrSeedingHitStore& hitStore, float zRef, float maxChi2InTrack,
+                                    PrSeedCandidate& track, const MomentsOf<T>& moments, unsigned int& worst ) {
+
+  //== The moments in z do not depend on the parameters: the x hits ones for the first iteration,
+  //== the ones of all hits for the next ones
+  float s0   = float( moments.s0 );
+  float sz   = float( moments.sz );
+  float sz2  = float( moments.sz2 );
+  float sz3  = float( moments.sz3 );
+  float sz4  = float( moments.sz4 );
+  const float t0  = float( moments.t0 );
+  const float tz  = float( moments.tz );
+  const float tz2 = float( moments.tz2 );
+
+  //== Residual sums of the next iteration, the first one uses the x hits only
+  float sd   = 0.;
+  float sdz  = 0.;
+  float sdz2 = 0.;
+  float td   = 0.;
+  float tdz  = 0.;
+
+  for ( PrHitIndices::const_iterator itH = track.hits().begin(); track.hits().end() != itH; ++itH ) {
+    if ( hitStore.dxDy( *itH ) != 0 ) continue;
+    float w = hitStore.w( *itH );
+    float z = hitStore.z( *itH ) - zRef;
+    float d = track.distance( hitStore, *itH );
+    sd   += w * d;
+    sdz  += w * d * z;
+    sdz2 += w * d * z * z;
+  }
+
+  for ( int loop = 0; 3 > loop ; ++loop ) {
+    //== Fit a parabola
+    if ( 1 == loop ) {
+      s0  = float( moments.a0 );
+      sz  = float( moments.az );
+      sz2 = float( moments.az2 );
+      sz3 = float( moments.az3 );
+      sz4 = float( moments.az4 );
+    }
+    float b1 = sz  * sz  - s0  * sz2;
+    float c1 = sz2 * sz  - s0  * sz3;
+    float d1 = sd  * sz  - s0  * sdz;
+    float b2 = sz2 * sz2 - sz * sz3;
+    float c2 = sz3 * sz2 - sz * sz4;
+    float d2 = sdz * sz2 - sz * sdz2;
+
+    float den = (b1 * c2 - b2 * c1 );
+    if( fabs(den) < 1e-9 ) {
+      // -- The parameters are those of the last chi2 pass, if there was one
+      if ( 0 == loop ) worst = worstHit( hitStore, track );
+      return false;
+    }
+    float db  = (d1 * c2 - d2 * c1 ) / den;
+    float dc  = (d2 * b1 - d1 * b2 ) / den;
+    float da  = ( sd - db * sz - dc * sz2 ) / s0;
+
+    float day = 0.;
+    float dby = 0.;
+    if ( 0 < loop && t0 > 0. ) {
+      float deny = (tz  * tz - t0 * tz2);
+      day = -(tdz * tz - td * tz2) / deny;
+      dby = -(td  * tz - t0 * tdz) / deny;
+    }
+
+    track.updateParameters( da, db, dc, day, dby );
+
+    //== The chi2 pass also sums the residuals of all hits for the next iteration, and finds the worst hit
+    float maxChi2 = 0.;
+    sd   = 0.;
+    sdz  = 0.;
+    sdz2 = 0.;
+    td   = 0.;
+    tdz  = 0.;
+    worst = 0;
+    for ( unsigned int iH = 0; track.hits().size() > iH; ++iH ) {
+      const unsigned int hit = track.hits()[iH];
+      float w = hitStore.w( hit );
+      float z = hitStore.z( hit ) - zRef;
+      float d = track.distance( hitStore, hit );
+      float chi2 = d * d * w;
+      if ( chi2 > maxChi2 ) {
+        maxChi2 = chi2;
+        worst = iH;
+      }
+      if ( hitStore.dxDy( hit ) != 0 ) {
+        float dy = d / hitStore.dxDy( hit );
+        td   += w * dy;
+        tdz  += w * dy * z;
+      }
+      sd   += w * d;
+      sdz  += w * d * z;
+      sdz2 += w * d * z * z;
+    }
+    if ( maxChi2InTrack > maxChi2 ) return true;
+  }
+  return false;
+}
+
+//=========================================================================
+//  Position of the hit with the largest chi2
+//=========================================================================
+PRSEEDING_NO_CONTRACT
+unsigned int PrSeedingBatchFit::worstHit( const PrSeedingHitStore& hitStore, const PrSeedCandidate& track ) {
+  float maxChi2 = 0.;
+  unsigned int worst = 0;
+  for ( unsigned int iH = 0; track.hits().size() > iH; ++iH ) {
+    float chi2 = track.chi2( hitStore, track.hits()[iH] );
+    if ( chi2 > maxChi2 ) {
+      maxChi2 = chi2;
+      worst = iH;
+    }
+  }
+  return worst;
+}
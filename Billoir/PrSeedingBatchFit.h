@@ -0,0 +1,165 @@
+#ifndef PRSEEDINGBATCHFIT_H
+#define PRSEEDINGBATCHFIT_H 1
+
+// Include files
+#include <vector>
+
+#include "PrSeedCandidate.h"
+#include "PrSeedingHitStore.h"
+#include "PrSeedingSimd.h"
+
+/** @class PrSeedingBatchFit PrSeedingBatchFit.h
+ *  Parabola + straight line in y fit of many track candidates at once, one candidate
+ *  per SIMD lane: 16 lanes with AVX-512, 8 with AVX2, 4 with SSE4.2, as chosen with
+ *  setLevel(). Each candidate goes through the same steps as in the scalar fitTrack(), which
+ *  fits one candidate for the refits: up to three iterations, the first one with the x hits
+ *  only, stopping as soon as no hit has a chi2 above maxChi2InTrack.
+ *
+ *  The candidates are packed by blocks of 16 in structure-of-arrays form, the hits of
+ *  shorter candidates are padded with hits of zero weight.
+ */
+class PrSeedingBatchFit {
+public:
+  enum { blockSize = 16 };
+
+  PrSeedingBatchFit() { setLevel( PrSeedingSimd::Scalar ); }
+
+  /// Instruction set of the kernel, which must be supported by the CPU
+  void setLevel( PrSeedingSimd::Level level );
+
+  /** @brief Fit the tracks, equivalent to calling fitTrack on each of them
+   *  @param store The hits of the event
+   *  @param zRef Reference z of the track parametrisation
+   *  @param maxChi2InTrack Maximum chi2 of a hit for the fit to succeed
+   *  @param tracks The tracks to fit, updated in place
+   *  @param nTracks Number of tracks
+   */
+  void fit( const PrSeedingHitStore& store, float zRef, float maxChi2InTrack,
+            PrSeedCandidate* tracks, unsigned int nTracks );
+
+  /** @class MomentsOf
+   *  Weighted moments in z of the hits of a track, which do not depend on its parameters: of its
+   *  x hits (s), stereo hits (t) and all hits (a). A hit is added or removed in O(1), so that the
+   *  refit after the removal of an outlier does not sum them again over all hits.
+   *
+   *  The fit sums them in float, in the order of the hits, as the kernels do. The moments kept
+   *  over removals are in double: the odd ones cancel between the hits before and after zRef,
+   *  and removing a hit in float would leave the rounding of the larger sum.
+   */
+  template <typename T>
+  struct MomentsOf {
+    MomentsOf() { clear(); }
+
+    /// Moments of the hits of the track
+    MomentsOf( const PrSeedingHitStore& store, float zRef, const PrSeedCandidate& track ) {
+      clear();
+      for ( PrHitIndices::const_iterator itH = track.hits().begin(); track.hits().end() != itH; ++itH ) {
+        add( store, zRef, *itH );
+      }
+    }
+
+    void clear() { s0 = sz = sz2 = sz3 = sz4 = a0 = az = az2 = az3 = az4 = t0 = tz = tz2 = 0.; }
+
+    void add( const PrSeedingHitStore& store, float zRef, unsigned int hit ) { update( store, zRef, hit, 1 ); }
+
+    /// Remove a hit which was added: the moments are then those of the other hits, up to the rounding
+    void remove( const PrSeedingHitStore& store, float zRef, unsigned int hit ) { update( store, zRef, hit, -1 ); }
+
+    T s0, sz, sz2, sz3, sz4;
+    T a0, az, az2, az3, az4;
+    T t0, tz, tz2;
+
+  private:
+    /// The terms are the products of the fit, in the same order; sign is +1 or -1, exact
+    PRSEEDING_NO_CONTRACT
+    void update( const PrSeedingHitStore& store, float zRef, unsigned int hit, int sign ) {
+      const T w   = T( sign ) * store.w( hit );
+      const T z   = store.z( hit ) - zRef;
+      const T wz  = w * z;
+      const T wz2 = wz * z;
+      if ( store.dxDy( hit ) != 0 ) {
+        t0  += w;
+        tz  += wz;
+        tz2 += wz2;
+      } else {
+        s0  += w;
+        sz  += wz;
+        sz2 += wz2;
+        sz3 += wz2 * z;
+        sz4 += wz2 * z * z;
+      }
+      a0  += w;
+      az  += wz;
+      az2 += wz2;
+      az3 += wz2 * z;
+      az4 += wz2 * z * z;
+    }
+  };
+
+  /// Moments kept by the caller over the removals of hits
+  typedef MomentsOf<double> Moments;
+
+  /** @brief Scalar fit of one track, which the kernels of all levels reproduce bit for bit
+   *  @param store The hits of the event
+   *  @param zRef Reference z of the track parametrisation
+   *  @param maxChi2InTrack Maximum chi2 of a hit for the fit to succeed
+   *  @param track The track to fit, updated in place
+   *  @param worst Set to the position of the hit with the largest chi2
+   *  @return bool Success of the fit
+   */
+  static bool fitTrack( const PrSeedingHitStore& store, float zRef, float maxChi2InTrack,
+                        PrSeedCandidate& track, unsigned int& worst );
+
+  /** @brief Scalar fit of one track, with the moments of its hits kept by the caller
+   *  @param moments The moments of the hits of the track, e.g. downdated for a removed hit
+   *  @see fitTrack
+   */
+  static bool fitTrack( const PrSeedingHitStore& store, float zRef, float maxChi2InTrack,
+                        PrSeedCandidate& track, const Moments& moments, unsigned int& worst );
+
+  /// Result of the fit of the track i of the last call, as returned by fitTrack
+  bool ok( unsigned int i ) const { return 0 != m_ok[i]; }
+
+  /// Position of the hit with the largest chi2 in the track i of the last call, as given by fitTrack
+  unsigned int worst( unsigned int i ) const { return m_worst[i]; }
+
+  /// Structure-of-arrays block of candidates, [hit][lane] for the hits
+  struct Block {
+    unsigned int       nHits;
+    std::vector<float> x;
+    std::vector<float> z;
+    std::vector<float> w;
+    std::vector<float> dxDy;
+    std::vector<float> dzDy;
+    float ax[blockSize];
+    float bx[blockSize];
+    float cx[blockSize];
+    float ay[blockSize];
+    float by[blockSize];
+    int   used[blockSize];  ///< lane holds a candidate
+    int   ok[blockSize];
+    int   worst[blockSize];  ///< hit with the largest chi2 in the last iteration
+  };
+
+  /// Fit of the first n lanes of a block, in place
+  typedef void (*FitBlock)( Block& block, unsigned int n, float zRef, float maxChi2InTrack );
+
+  /// Kernel of the instruction set, which must be supported by the CPU
+  static FitBlock kernel( PrSeedingSimd::Level level );
+
+private:
+  /// The fit of fitTrack, from the moments of the hits of the track, rounded to float
+  template <typename T>
+  static bool fitMoments( const PrSeedingHitStore& store, float zRef, float maxChi2InTrack,
+                          PrSeedCandidate& track, const MomentsOf<T>& moments, unsigned int& worst );
+
+  /// Position in the track of the hit with the largest chi2
+  static unsigned int worstHit( const PrSeedingHitStore& store, const PrSeedCandidate& track );
+
+  FitBlock                   m_fitBlock;
+  unsigned int               m_lanes;
+  Block                      m_block;
+  std::vector<unsigned char> m_ok;
+  std::vector<unsigned int>  m_worst;
+};
+#endif // PRSEEDINGBATCHFIT_H
@@ -0,0 +1,39 @@
+#ifndef PRSEEDINGCANDIDATEINDEX_H
+#define PRSEEDINGCANDIDATEINDEX_H 1
+
+// Include files
+#include <vector>
+
+/** @class PrSeedingCandidateIndex PrSeedingCandidateIndex.h
+ *  Inverted index from the hits of the PrSeedingHitStore to the track candidates using
+ *  them, in compressed rows: the candidates of hit h are [begin( h ), end( h )), by
+ *  increasing position in the container given to build().
+ *
+ *  The memory is kept from one event to the next.
+ */
+class PrSeedingCandidateIndex {
+public:
+  /// Index the hits of the tracks, which are indices below nHits
+  template <typename Tracks>
+  void build( const Tracks& tracks, unsigned int nHits ) {
+    m_begin.assign( nHits + 1, 0 );
+    for ( typename Tracks::const_iterator itT = tracks.begin(); tracks.end() != itT; ++itT ) {
+      for ( auto itH = (*itT).hits().begin(); (*itT).hits().end() != itH; ++itH ) ++m_begin[*itH];
+    }
+    // -- m_begin[h] is first the end of the row of h, it moves to its start while the row is filled
+    for ( unsigned int h = 1; nHits >= h; ++h ) m_begin[h] += m_begin[h-1];
+    m_tracks.resize( m_begin[nHits] );
+    for ( unsigned int t = tracks.size(); 0 < t; --t ) {
+      const auto& hits = tracks[t-1].hits();
+      for ( auto itH = hits.begin(); hits.end() != itH; ++itH ) m_tracks[--m_begin[*itH]] = t - 1;
+    }
+  }
+
+  const unsigned int* begin( unsigned int hit ) const { return m_tracks.data() + m_begin[hit]; }
+  const unsigned int* end( unsigned int hit )   const { return m_tracks.data() + m_begin[hit+1]; }
+
+private:
+  std::vector<unsigned int> m_begin;
+  std::vector<unsigned int> m_tracks;
+};
+#endif // PRSEEDINGCANDIDATEINDEX_H
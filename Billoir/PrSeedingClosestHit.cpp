@@ -0,0 +1,150 @@
+// Include files
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// local
+#include "PrSeedingClosestHit.h"
+
+//-----------------------------------------------------------------------------
+// Implementation file for namespace : PrSeedingClosestHit
+//
+// Written with the GCC vector extensions, for W lanes, and compiled once per instruction
+// set of PrSeedingSimd. Each lane keeps the closest hit among the hits it has seen, the
+// lanes are only compared at the end of the window.
+//-----------------------------------------------------------------------------
+
+// The helpers taking or returning vectors are always inlined in a function of their
+// instruction set, their ABI outside of it does not matter
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace {
+
+  /// Maximum number of predictions searched in the same pass
+  const unsigned int maxGroup = 16;
+
+  /// Hits of [base, base + W), the ones after end are put at +infinity
+  template <unsigned int W>
+  PRSEEDING_KERNEL typename PrSeedingSimd::Lanes<W>::F load( const float* x, unsigned int base, unsigned int end ) {
+    typename PrSeedingSimd::Lanes<W>::F xs;
+    if ( base + W <= end ) {
+      std::memcpy( &xs, x + base, sizeof( xs ) );
+    } else {
+      float buf[W];
+      std::fill( buf, buf + W, std::numeric_limits<float>::infinity() );
+      std::copy( x + base, x + end, buf );
+      std::memcpy( &xs, buf, sizeof( xs ) );
+    }
+    return xs;
+  }
+
+  /// Minimum over the lanes, in all lanes
+  template <unsigned int W, typename V>
+  PRSEEDING_KERNEL V minLanes( const V& values ) {
+    V v = values;
+    for ( unsigned int k = W / 2; 0 < k; k /= 2 ) {
+      typename PrSeedingSimd::Lanes<W>::I mask;
+      for ( unsigned int l = 0; W > l; ++l ) mask[l] = ( l + k ) % W;
+      const V r = __builtin_shuffle( v, mask );
+      v = r < v ? r : v;
+    }
+    return v;
+  }
+
+  /// Search of the closest hits for the n <= N predictions from h0, which are in [start, hi]
+  template <unsigned int W, unsigned int N>
+  PRSEEDING_KERNEL void findGroup( const float* x, unsigned int start, unsigned int end, float hi,
+                                   unsigned int h0, unsigned int n, const float* xPred, const float* xMin,
+                                   const float* xMax, float maxDist, int* best ) {
+    typedef typename PrSeedingSimd::Lanes<W>::F F;
+    typedef typename PrSeedingSimd::Lanes<W>::I I;
+    const int none = std::numeric_limits<int>::max();
+    I lane;
+    for ( unsigned int l = 0; W > l; ++l ) lane[l] = l;
+
+    F bestDist[N];
+    I bestHit[N];
+    for ( unsigned int g = 0; n > g; ++g ) {
+      bestDist[g] = F{} + maxDist;
+      bestHit[g]  = I{} + none;
+    }
+
+    // -- Strict comparison: in each lane, the first of equally close hits is kept
+    for ( unsigned int base = start; end > base && x[base] <= hi; base += W ) {
+      const F xs  = load<W>( x, base, end );
+      const I hit = lane + (int)base;
+      for ( unsigned int g = 0; n > g; ++g ) {
+        const F d  = xs - xPred[h0+g];
+        const F ad = d < 0.f ? -d : d;
+        const I in = ( xs >= xMin[h0+g] ) & ( xs <= xMax[h0+g] ) & ( ad < bestDist[g] );
+        bestDist[g] = in ? ad  : bestDist[g];
+        bestHit[g]  = in ? hit : bestHit[g];
+      }
+    }
+
+    // -- Closest over the lanes, the first hit on ties
+    for ( unsigned int g = 0; n > g; ++g ) {
+      const F dist = minLanes<W>( bestDist[g] );
+      const I hit  = minLanes<W>( bestDist[g] == dist ? bestHit[g] : I{} + none );
+      best[h0+g] = none == hit[0] ? -1 : hit[0];
+    }
+  }
+
+  template <unsigned int W>
+  PRSEEDING_KERNEL void find( const float* x, const unsigned int* first, unsigned int end, unsigned int nHyp,
+                              const float* xPred, const float* xMin, const float* xMax, float maxDist, int* best ) {
+    unsigned int iHyp = 0;
+    while ( nHyp > iHyp ) {
+      // -- Consecutive predictions with overlapping windows are searched in the same pass
+      unsigned int start  = first[iHyp];
+      float        lo     = xMin[iHyp];
+      float        hi     = xMax[iHyp];
+      unsigned int nGroup = 1;
+      while ( nHyp > iHyp + nGroup && maxGroup > nGroup &&
+              xMin[iHyp+nGroup] <= hi && xMax[iHyp+nGroup] >= lo ) {
+        start = std::min( start, first[iHyp+nGroup] );
+        lo    = std::min( lo, xMin[iHyp+nGroup] );
+        hi    = std::max( hi, xMax[iHyp+nGroup] );
+        ++nGroup;
+      }
+
+      // -- The state of a single prediction stays in registers
+      if ( 1 == nGroup ) {
+        findGroup<W, 1>( x, start, end, hi, iHyp, 1, xPred, xMin, xMax, maxDist, best );
+      } else {
+        findGroup<W, maxGroup>( x, start, end, hi, iHyp, nGroup, xPred, xMin, xMax, maxDist, best );
+      }
+      iHyp += nGroup;
+    }
+  }
+
+  PRSEEDING_TARGET( "sse4.2" )
+  void findSSE42( const float* x, const unsigned int* first, unsigned int end, unsigned int nHyp,
+                  const float* xPred, const float* xMin, const float* xMax, float maxDist, int* best ) {
+    find<4>( x, first, end, nHyp, xPred, xMin, xMax, maxDist, best );
+  }
+
+  PRSEEDING_TARGET( "avx2" )
+  void findAVX2( const float* x, const unsigned int* first, unsigned int end, unsigned int nHyp,
+                 const float* xPred, const float* xMin, const float* xMax, float maxDist, int* best ) {
+    find<8>( x, first, end, nHyp, xPred, xMin, xMax, maxDist, best );
+  }
+
+  PRSEEDING_TARGET( "avx512f" )
+  void findAVX512( const float* x, const unsigned int* first, unsigned int end, unsigned int nHyp,
+                   const float* xPred, const float* xMin, const float* xMax, float maxDist, int* best ) {
+    find<16>( x, first, end, nHyp, xPred, xMin, xMax, maxDist, best );
+  }
+}
+
+//=========================================================================
+//  Choose the kernel
+//=========================================================================
+PrSeedingClosestHit::Find PrSeedingClosestHit::select( PrSeedingSimd::Level level ) {
+  switch ( level ) {
+  case PrSeedingSimd::SSE42:  return findSSE42;
+  case PrSeedingSimd::AVX2:   return findAVX2;
+  case PrSeedingSimd::AVX512: return findAVX512;
+  default:                    return nullptr;
+  }
+}
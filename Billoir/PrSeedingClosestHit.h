@@ -0,0 +1,60 @@
+#ifndef PRSEEDINGCLOSESTHIT_H
+#define PRSEEDINGCLOSESTHIT_H 1
+
+// Include files
+#include <cmath>
+
+#include "PrSeedingSimd.h"
+
+/** Search of the hit closest to several predictions in the same zone, as needed for the
+ *  parabola hypotheses of a doublet: the hits are read by steps of 16 with AVX-512, 8 with
+ *  AVX2 or 4 with SSE4.2, and compared without branches to all the predictions whose
+ *  windows overlap, so that a window shared by several hypotheses is read once.
+ *
+ *  A window of less hits than lanes does not fill a step, and is faster to scan hit by
+ *  hit with scan(), which is also the search of the scalar level and the reference of the kernels.
+ */
+namespace PrSeedingClosestHit {
+
+  /** @brief For each prediction h, find the hit with xMin[h] <= x <= xMax[h] closest to xPred[h],
+   *         at a distance below maxDist. Ties go to the first hit, as in a sequential scan.
+   *  @param x Positions of the hits, sorted
+   *  @param first First hit of each window, i.e. with x >= xMin
+   *  @param end End of the hits of the zone
+   *  @param nHyp Number of predictions
+   *  @param xPred Predicted positions
+   *  @param xMin Lower edges of the windows
+   *  @param xMax Upper edges of the windows
+   *  @param maxDist Maximum distance to the prediction
+   *  @param best Index of the closest hit for each prediction, -1 if none
+   */
+  typedef void (*Find)( const float* x, const unsigned int* first, unsigned int end, unsigned int nHyp,
+                        const float* xPred, const float* xMin, const float* xMax, float maxDist, int* best );
+
+  /// The search for this instruction set, nullptr for the scalar level
+  Find select( PrSeedingSimd::Level level );
+
+  /** @brief Hit with x <= xMax closest to xPred, at a distance below maxDist, scanned hit by hit.
+   *         Ties go to the first hit.
+   *  @param x Positions of the hits, sorted
+   *  @param first First hit of the window, i.e. with x >= xMin
+   *  @param end End of the hits of the zone
+   *  @param xPred Predicted position
+   *  @param xMax Upper edge of the window
+   *  @param maxDist Maximum distance to the prediction
+   *  @return int Index of the closest hit, -1 if none
+   */
+  inline int scan( const float* x, unsigned int first, unsigned int end, float xPred, float xMax, float maxDist ) {
+    int   best     = -1;
+    float bestDist = maxDist;
+    for ( unsigned int iH = first; end != iH; ++iH ) {
+      if ( x[iH] > xMax ) break;
+      if ( std::fabs( x[iH] - xPred ) < bestDist ) {
+        bestDist = std::fabs( x[iH] - xPred );
+        best     = iH;
+      }
+    }
+    return best;
+  }
+}
+#endif // PRSEEDINGCLOSESTHIT_H
@@ -0,0 +1,68 @@
+#ifndef PRSEEDINGCURVATURETABLE_H
+#define PRSEEDINGCURVATURETABLE_H 1
+
+// Include files
+#include <vector>
+
+/** @class PrSeedingCurvatureTable PrSeedingCurvatureTable.h
+ *  Expected curvature of the x projection in the T stations, i.e. the |c| of
+ *  x = a + b*dz + c*dz*dz, and its spread, as a function of the slope tx and of the x at
+ *  z = 0 of the straight line through two hits of the track. Uniform grid over
+ *  [-txMax, txMax] x [-x0Max, x0Max], the points outside take the value of the closest bin.
+ *
+ *  The sign of the curvature is not in the table: it is the one of x0 for all polarities.
+ */
+class PrSeedingCurvatureTable {
+public:
+  PrSeedingCurvatureTable() : m_nTx( 0 ), m_nX0( 0 ), m_txMax( 0. ), m_x0Max( 0. ), m_txScale( 0. ), m_x0Scale( 0. ) {}
+
+  /** @brief Fill the table with f( tx, x0, curvature, spread ) at the centres of the bins
+   *  @param nTx Number of bins in tx
+   *  @param txMax Upper edge in tx
+   *  @param nX0 Number of bins in x0
+   *  @param x0Max Upper edge in x0
+   *  @param f Gives the curvature and its spread at ( tx, x0 )
+   */
+  template <typename F>
+  void build( unsigned int nTx, float txMax, unsigned int nX0, float x0Max, F f ) {
+    m_nTx     = nTx;
+    m_nX0     = nX0;
+    m_txMax   = txMax;
+    m_x0Max   = x0Max;
+    m_txScale = 0.5f * nTx / txMax;
+    m_x0Scale = 0.5f * nX0 / x0Max;
+    m_curvature.assign( nTx * nX0, 0. );
+    m_spread.assign( nTx * nX0, 0. );
+    for ( unsigned int iTx = 0; nTx > iTx; ++iTx ) {
+      const float tx = ( iTx + 0.5f ) / m_txScale - txMax;
+      for ( unsigned int iX0 = 0; nX0 > iX0; ++iX0 ) {
+        const float x0 = ( iX0 + 0.5f ) / m_x0Scale - x0Max;
+        f( tx, x0, m_curvature[iTx * nX0 + iX0], m_spread[iTx * nX0 + iX0] );
+      }
+    }
+  }
+
+  /// Curvature and spread of the bin of ( tx, x0 )
+  void lookup( float tx, float x0, float& curvature, float& spread ) const {
+    const unsigned int k = bin( tx, m_txMax, m_txScale, m_nTx ) * m_nX0 + bin( x0, m_x0Max, m_x0Scale, m_nX0 );
+    curvature = m_curvature[k];
+    spread    = m_spread[k];
+  }
+
+private:
+  static unsigned int bin( float v, float vMax, float scale, unsigned int n ) {
+    const float b = ( v + vMax ) * scale;
+    if ( !( b > 0. ) ) return 0;
+    return b < n ? static_cast<unsigned int>( b ) : n - 1;
+  }
+
+  unsigned int       m_nTx;
+  unsigned int       m_nX0;
+  float              m_txMax;
+  float              m_x0Max;
+  float              m_txScale;
+  float              m_x0Scale;
+  std::vector<float> m_curvature;
+  std::vector<float> m_spread;
+};
+#endif // PRSEEDINGCURVATURETABLE_H
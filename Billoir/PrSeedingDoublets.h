@@ -0,0 +1,96 @@
+#ifndef PRSEEDINGDOUBLETS_H
+#define PRSEEDINGDOUBLETS_H 1
+
+// Include files
+#include <vector>
+
+#include "PrSeedingHitStore.h"
+#include "PrSeedingUsedHits.h"
+
+/** @class PrSeedingDoublets PrSeedingDoublets.h
+ *  Pairs of hits of the first and last x zones of a case, from which the x projections are
+ *  searched: the last hit is in the window given by MaxIpAtZero around the straight line
+ *  from the origin through the first hit.
+ *
+ *  The pairs are grouped by first hit, in the order of the hits; the pairs of group g are
+ *  [begin( g ), end( g )). The slope and the x at z = 0 of the line through each pair are
+ *  computed in a separate loop over the arrays, after all pairs are found.
+ */
+class PrSeedingDoublets {
+public:
+  typedef PrHitIndices::allocator_type allocator_type;
+
+  explicit PrSeedingDoublets( const allocator_type& alloc )
+    : m_firstHit( alloc ), m_groupBegin( 1, 0, alloc ), m_last( alloc ), m_tx( alloc ), m_x0( alloc ) {}
+
+  /** @brief Find the pairs of the two zones, without the hits which are used
+   *  @param store The hits of the event
+   *  @param used Used flags of the hits, nullptr to take all hits
+   *  @param firstZone First x zone
+   *  @param lastZone Last x zone
+   *  @param zFirst z of the first zone
+   *  @param zLast z of the last zone
+   *  @param maxIpAtZero Maximum impact parameter at z = 0
+   */
+  void build( const PrSeedingHitStore& store, const PrSeedingUsedHits* used,
+              unsigned int firstZone, unsigned int lastZone, float zFirst, float zLast, float maxIpAtZero ) {
+    m_firstHit.clear();
+    m_groupBegin.resize( 1 );
+    m_last.clear();
+    const unsigned int fEnd = store.end( firstZone );
+    const unsigned int lEnd = store.end( lastZone );
+    for ( unsigned int iF = store.begin( firstZone ); fEnd != iF; ++iF ) {
+      if ( used && used->isUsed( iF ) ) continue;
+      float minXl, maxXl;
+      lastWindow( store.x( iF ), zFirst, zLast, maxIpAtZero, minXl, maxXl );
+      for ( unsigned int iL = store.lowerBoundX( lastZone, minXl ); lEnd != iL && store.x( iL ) < maxXl; ++iL ) {
+        if ( used && used->isUsed( iL ) ) continue;
+        m_last.push_back( iL );
+      }
+      m_firstHit.push_back( iF );
+      m_groupBegin.push_back( m_last.size() );
+    }
+
+    // -- Lines through the pairs, one pass over contiguous arrays
+    const unsigned int n = m_last.size();
+    m_tx.resize( n );
+    m_x0.resize( n );
+    const float dz = zLast - zFirst;
+    for ( unsigned int g = 0; m_firstHit.size() > g; ++g ) {
+      const float xF = store.x( m_firstHit[g] );
+      const float zF = store.z( m_firstHit[g] );
+      for ( unsigned int k = m_groupBegin[g]; m_groupBegin[g+1] > k; ++k ) {
+        m_tx[k] = ( store.x( m_last[k] ) - xF ) / dz;
+        m_x0[k] = xF - zF * m_tx[k];
+      }
+    }
+  }
+
+  /// Window in x in the last zone for a hit at xF in the first zone
+  static void lastWindow( float xF, float zFirst, float zLast, float maxIpAtZero, float& minXl, float& maxXl ) {
+    const float zRatio = zLast / zFirst;
+    minXl = xF * zRatio - maxIpAtZero * ( zRatio - 1 );
+    maxXl = xF * zRatio + maxIpAtZero * ( zRatio - 1 );
+  }
+
+  /// Number of first hits, also those without pairs
+  unsigned int nGroups() const { return m_firstHit.size(); }
+
+  unsigned int firstHit( unsigned int g ) const { return m_firstHit[g]; }
+  unsigned int begin( unsigned int g )    const { return m_groupBegin[g]; }
+  unsigned int end( unsigned int g )      const { return m_groupBegin[g+1]; }
+
+  unsigned int lastHit( unsigned int k ) const { return m_last[k]; }
+  float tx( unsigned int k )             const { return m_tx[k]; }
+  float x0( unsigned int k )             const { return m_x0[k]; }
+
+private:
+  typedef std::vector<float, PrSeedingArena::Allocator<float> > Floats;
+
+  PrHitIndices m_firstHit;
+  PrHitIndices m_groupBegin;
+  PrHitIndices m_last;
+  Floats       m_tx;
+  Floats       m_x0;
+};
+#endif // PRSEEDINGDOUBLETS_H
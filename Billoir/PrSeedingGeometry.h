@@ -0,0 +1,115 @@
+#ifndef PRSEEDINGGEOMETRY_H
+#define PRSEEDINGGEOMETRY_H 1
+
+// Include files
+#include <vector>
+
+#include "PrKernel/PrHitManager.h"
+
+/** @class PrSeedingGeometry PrSeedingGeometry.h
+ *  Flat copy of the geometry of the zones of the FT, as used by the seeding:
+ *  z, z - zRef, dxDy, dzDy, x or stereo and plane of each zone, and the zone lists
+ *  of each search. Built from the hit manager in initialize(), and again when the
+ *  detector geometry changes; clear(), addZone() and close() build it without one,
+ *  e.g. in the tests.
+ *
+ *  Zone n is in layer n/2; even zones are the upper half (part 0), odd zones the lower half.
+ */
+class PrSeedingGeometry {
+public:
+  enum { nParts = 2, nCases = 3 };
+
+  typedef std::vector<unsigned int> Zones;
+
+  PrSeedingGeometry() : m_zRef( 0. ) {}
+
+  void build( PrHitManager* hitManager, float zRef ) {
+    clear( zRef );
+    for ( unsigned int zone = 0; hitManager->nbZones() > zone; ++zone ) {
+      const PrHitZone* hitZone = hitManager->zone( zone );
+      addZone( hitZone->z(), hitZone->dxDy(), hitZone->dzDy(), hitZone->isX() );
+    }
+    close();
+  }
+
+  /// Empty the table. Then addZone() for each zone, in the order of the hit manager, and close().
+  void clear( float zRef ) {
+    m_zRef = zRef;
+    m_zones.clear();
+  }
+
+  /// Add the next zone
+  void addZone( float z, float dxDy, float dzDy, bool isX ) {
+    Zone zone;
+    zone.z         = z;
+    zone.dz        = z - m_zRef;
+    zone.dxDy      = dxDy;
+    zone.dzDy      = dzDy;
+    zone.isX       = isX;
+    zone.planeCode = m_zones.size() / 2;
+    m_zones.push_back( zone );
+  }
+
+  /// Make the zone lists of the searches, from the 24 zones
+  void close() {
+    for ( unsigned int part = 0; nParts > part; ++part ) {
+      for ( unsigned int iCase = 0; nCases > iCase; ++iCase ) {
+        unsigned int firstZone = part;
+        unsigned int lastZone  = 22 + part;
+        if ( 1 == iCase ) firstZone = part + 6;
+        if ( 2 == iCase ) lastZone  = 16 + part;
+        m_firstZone[part][iCase] = firstZone;
+        m_lastZone[part][iCase]  = lastZone;
+
+        // -- x zones strictly between the first and last zone of the search
+        m_xZones[part][iCase].clear();
+        for ( unsigned int kk = firstZone + 2; lastZone > kk; kk += 2 ) {
+          if ( m_zones[kk].isX ) m_xZones[part][iCase].push_back( kk );
+        }
+      }
+      m_stereoZones[part].clear();
+      for ( unsigned int kk = part + 2; part + 22 > kk; kk += 2 ) {
+        if ( !m_zones[kk].isX ) m_stereoZones[part].push_back( kk );
+      }
+    }
+  }
+
+  float zRef() const { return m_zRef; }
+
+  unsigned int nZones() const { return m_zones.size(); }
+
+  float z( unsigned int zone )            const { return m_zones[zone].z; }
+  float dz( unsigned int zone )           const { return m_zones[zone].dz; }
+  float dxDy( unsigned int zone )         const { return m_zones[zone].dxDy; }
+  float dzDy( unsigned int zone )         const { return m_zones[zone].dzDy; }
+  bool isX( unsigned int zone )           const { return m_zones[zone].isX; }
+  unsigned int planeCode( unsigned int zone ) const { return m_zones[zone].planeCode; }
+
+  /// First and last zone of the x search of this half, for case 0, 1 or 2
+  unsigned int firstZone( unsigned int part, unsigned int iCase ) const { return m_firstZone[part][iCase]; }
+  unsigned int lastZone( unsigned int part, unsigned int iCase )  const { return m_lastZone[part][iCase]; }
+
+  /// x zones between the first and last zone, ordered in z
+  const Zones& xZones( unsigned int part, unsigned int iCase ) const { return m_xZones[part][iCase]; }
+
+  /// Stereo zones of this half, ordered in z
+  const Zones& stereoZones( unsigned int part ) const { return m_stereoZones[part]; }
+
+private:
+  struct Zone {
+    float         z;
+    float         dz;
+    float         dxDy;
+    float         dzDy;
+    bool          isX;
+    unsigned char planeCode;
+  };
+
+  float             m_zRef;
+  std::vector<Zone> m_zones;
+  unsigned int      m_firstZone[nParts][nCases];
+  unsigned int      m_lastZone[nParts][nCases];
+  Zones             m_xZones[nParts][nCases];
+  Zones             m_stereoZones[nParts];
+};
+#endif // PRSEEDINGGEOMETRY_H
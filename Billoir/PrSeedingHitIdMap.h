@@ -0,0 +1,61 @@
+#ifndef PRSEEDINGHITIDMAP_H
+#define PRSEEDINGHITIDMAP_H 1
+
+// Include files
+#include <vector>
+
+/** @class PrSeedingHitIdMap PrSeedingHitIdMap.h
+ *  Open-addressing hash map from the LHCbID of a hit to its index in the PrSeedingHitStore.
+ *  Linear probing in a power-of-two table kept at most half full; the table keeps its
+ *  memory from one event to the next, so that clear() and insert() do not allocate in
+ *  steady state.
+ */
+class PrSeedingHitIdMap {
+public:
+  PrSeedingHitIdMap() : m_mask( 0 ), m_shift( 32 ) {}
+
+  /// Empty the map, with room for nHits hits
+  void clear( unsigned int nHits ) {
+    unsigned int size = 16;
+    m_shift = 28;
+    while ( size < 2 * nHits ) {
+      size *= 2;
+      --m_shift;
+    }
+    m_mask = size - 1;
+    m_slots.assign( size, Slot() );
+  }
+
+  void insert( unsigned int id, unsigned int hit ) {
+    unsigned int pos = hash( id );
+    while ( empty != m_slots[pos].hit ) pos = ( pos + 1 ) & m_mask;
+    m_slots[pos].id  = id;
+    m_slots[pos].hit = hit;
+  }
+
+  /// Call f( hit ) for each hit with this id
+  template <typename F>
+  void forEach( unsigned int id, F f ) const {
+    if ( m_slots.empty() ) return;
+    for ( unsigned int pos = hash( id ); empty != m_slots[pos].hit; pos = ( pos + 1 ) & m_mask ) {
+      if ( id == m_slots[pos].id ) f( m_slots[pos].hit );
+    }
+  }
+
+private:
+  enum { empty = ~0u };
+
+  struct Slot {
+    Slot() : id( 0 ), hit( empty ) {}
+    unsigned int id;
+    unsigned int hit;
+  };
+
+  /// Fibonacci hashing: the top bits of the product select the slot
+  unsigned int hash( unsigned int id ) const { return ( id * 2654435761u ) >> m_shift; }
+
+  unsigned int      m_mask;
+  unsigned int      m_shift;
+  std::vector<Slot> m_slots;
+};
+#endif // PRSEEDINGHITIDMAP_H
@@ -0,0 +1,92 @@
+#ifndef PRSEEDINGHITLISTS_H
+#define PRSEEDINGHITLISTS_H 1
+
+// Include files
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+#include "PrSeedingHitStore.h"
+#include "PrSeedingSort.h"
+
+/** @class PrSeedingHitLists PrSeedingHitLists.h
+ *  Set of distinct lists of hit indices, e.g. the x hits of the parabola hypotheses of a
+ *  doublet. The lists are stored one after the other in a single array, list k is
+ *  [begin( k ), end( k )), and each one has a 64 bit fingerprint of its hits: a new list
+ *  is only compared hit by hit to the lists with the same fingerprint.
+ *
+ *  The memory is kept by clear(), for the next doublet.
+ */
+class PrSeedingHitLists {
+public:
+  typedef PrHitIndices::allocator_type allocator_type;
+
+  explicit PrSeedingHitLists( const allocator_type& alloc )
+    : m_hits( alloc ), m_begin( 1, 0, alloc ), m_fingerprints( alloc ), m_order( alloc ) {}
+
+  void reserve( unsigned int nLists, unsigned int nHits ) {
+    m_hits.reserve( nHits );
+    m_begin.reserve( nLists + 1 );
+    m_fingerprints.reserve( nLists );
+    m_order.reserve( nLists );
+  }
+
+  void clear() {
+    m_hits.clear();
+    m_begin.resize( 1 );
+    m_fingerprints.clear();
+    m_order.clear();
+  }
+
+  unsigned int size() const { return m_fingerprints.size(); }
+
+  /// Add the list [first, last) if it is not in the set yet, return true if it was added
+  template <typename It>
+  bool insert( It first, It last ) {
+    const uint64_t key = fingerprint( first, last );
+    const unsigned int n = last - first;
+    for ( unsigned int k = 0; size() > k; ++k ) {
+      if ( key != m_fingerprints[k] ) continue;
+      if ( n == m_begin[k+1] - m_begin[k] && std::equal( first, last, m_hits.begin() + m_begin[k] ) ) return false;
+    }
+    m_hits.insert( m_hits.end(), first, last );
+    m_begin.push_back( m_hits.size() );
+    m_order.push_back( size() );
+    m_fingerprints.push_back( key );
+    return true;
+  }
+
+  /// Put the lists in lexicographic order of their hit indices
+  void sort( PrSeedingArena& arena ) {
+    const PrHitIndices& hits  = m_hits;
+    const PrHitIndices& begin = m_begin;
+    PrSeedingSort::stableSort( m_order.begin(), m_order.end(),
+                               [&hits, &begin]( unsigned int lhs, unsigned int rhs ) -> bool {
+                                 return std::lexicographical_compare( hits.begin() + begin[lhs], hits.begin() + begin[lhs+1],
+                                                                      hits.begin() + begin[rhs], hits.begin() + begin[rhs+1] );
+                               },
+                               arena );
+  }
+
+  /// Hits of the k-th list, in the insertion order or the one of sort()
+  const unsigned int* begin( unsigned int k ) const { return m_hits.data() + m_begin[m_order[k]]; }
+  const unsigned int* end( unsigned int k )   const { return m_hits.data() + m_begin[m_order[k]+1]; }
+
+  /// Position of the k-th list in the insertion order
+  unsigned int inserted( unsigned int k ) const { return m_order[k]; }
+
+  /// FNV-1a hash of the hit indices, one index at a time
+  template <typename It>
+  static uint64_t fingerprint( It first, It last ) {
+    uint64_t key = 14695981039346656037ULL;
+    for ( ; last != first; ++first ) key = ( key ^ *first ) * 1099511628211ULL;
+    return key;
+  }
+
+private:
+  PrHitIndices m_hits;       ///< Hits of all lists
+  PrHitIndices m_begin;      ///< Start of each list in m_hits, and the end of the last one
+  std::vector<uint64_t, PrSeedingArena::Allocator<uint64_t> > m_fingerprints;
+  PrHitIndices m_order;      ///< Lists in the order given by begin( k )
+};
+#endif // PRSEEDINGHITLISTS_H
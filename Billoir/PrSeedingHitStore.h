@@ -0,0 +1,152 @@
+#ifndef PRSEEDINGHITSTORE_H
+#define PRSEEDINGHITSTORE_H 1
+
+// Include files
+#include <algorithm>
+#include <vector>
+
+#include "PrKernel/PrHitManager.h"
+#include "PrSeedingArena.h"
+#include "PrSeedingGeometry.h"
+#include "PrSeedingHitIdMap.h"
+#include "PrSeedingXBuckets.h"
+
+/// Hits of a candidate, as indices into the PrSeedingHitStore, allocated in the event arena
+typedef std::vector<unsigned int, PrSeedingArena::Allocator<unsigned int> > PrHitIndices;
+
+/** @class PrSeedingHitStore PrSeedingHitStore.h
+ *  Per-event structure-of-arrays snapshot of the hits of all zones.
+ *  The hot loops of the seeding read x, z, w, id and plane code from contiguous
+ *  arrays instead of dereferencing one PrHit per hit.
+ *
+ *  A hit is identified by a single index; the hits of zone n are in [begin(n), end(n)),
+ *  in the order of the hit manager, i.e. sorted by x. forEachHit() finds the hits of an LHCbID,
+ *  lowerBoundX() uses a PrSeedingXBuckets grid per zone.
+ *
+ *  fill() copies the hits of the hit manager, with the dxDy, dzDy and plane code of their zone
+ *  from the geometry table; clear(), addZone(), addHit() and close() fill the store without
+ *  a hit manager, e.g. in the tests.
+ */
+class PrSeedingHitStore {
+public:
+  PrSeedingHitStore() : m_bucketWidth( 4. ) {}
+
+  /// Width of the bins of the x grid of the zones, used from the next fill()
+  void setBucketWidth( float width ) { m_bucketWidth = width; }
+
+  /// Copy the hits of the zones of the geometry table from the hit manager
+  void fill( PrHitManager* hitManager, const PrSeedingGeometry& geometry ) {
+    const unsigned int nZones = geometry.nZones();
+    unsigned int nHits = 0;
+    for ( unsigned int zone = 0; nZones > zone; ++zone ) nHits += hitManager->hits( zone ).size();
+    clear( nZones, nHits );
+
+    for ( unsigned int zone = 0; nZones > zone; ++zone ) {
+      addZone( geometry.dxDy( zone ), geometry.dzDy( zone ) );
+      const unsigned int planeCode = geometry.planeCode( zone );
+      PrHits& hits = hitManager->hits( zone );
+      for ( PrHits::const_iterator itH = hits.begin(); hits.end() != itH; ++itH ) {
+        addHit( (*itH)->x(), (*itH)->z(), (*itH)->w(), (*itH)->id().lhcbID(), planeCode, *itH );
+      }
+    }
+    close();
+  }
+
+  /// Empty the store, for nZones zones and nHits hits. Then addZone() for each zone, with its hits, and close().
+  void clear( unsigned int nZones, unsigned int nHits ) {
+    m_begin.assign( nZones + 1, 0 );
+    m_zoneDxDy.clear();
+    m_zoneDzDy.clear();
+    m_x.clear();
+    m_z.clear();
+    m_w.clear();
+    m_id.clear();
+    m_planeCode.clear();
+    m_zone.clear();
+    m_hits.clear();
+    m_idMap.clear( nHits );
+  }
+
+  /// Start the next zone, the hits added from now on are in it
+  void addZone( float dxDy, float dzDy ) {
+    m_begin[m_zoneDxDy.size()] = m_x.size();
+    m_zoneDxDy.push_back( dxDy );
+    m_zoneDzDy.push_back( dzDy );
+  }
+
+  /// Add a hit to the current zone, after the ones with a smaller x
+  void addHit( float x, float z, float w, unsigned int id, unsigned int planeCode, PrHit* hit ) {
+    m_x.push_back( x );
+    m_z.push_back( z );
+    m_w.push_back( w );
+    m_id.push_back( id );
+    m_planeCode.push_back( planeCode );
+    m_zone.push_back( m_zoneDxDy.size() - 1 );
+    m_idMap.insert( id, m_hits.size() );
+    m_hits.push_back( hit );
+  }
+
+  /// End of the last zone, build the x grids of the zones
+  void close() {
+    const unsigned int nZones = m_zoneDxDy.size();
+    m_begin[nZones] = m_x.size();
+    m_buckets.resize( nZones );
+    for ( unsigned int zone = 0; nZones > zone; ++zone ) {
+      const float* xs = m_x.data() + begin( zone );
+      m_buckets[zone].build( end( zone ) - begin( zone ), [xs]( unsigned int i ) { return xs[i]; }, m_bucketWidth );
+    }
+  }
+
+  unsigned int size()                   const { return m_x.size(); }
+  unsigned int begin( unsigned int zone ) const { return m_begin[zone]; }
+  unsigned int end  ( unsigned int zone ) const { return m_begin[zone+1]; }
+
+  float x( unsigned int hit )         const { return m_x[hit]; }
+  float z( unsigned int hit )         const { return m_z[hit]; }
+  float w( unsigned int hit )         const { return m_w[hit]; }
+  LHCb::LHCbID id( unsigned int hit ) const { return LHCb::LHCbID( m_id[hit] ); }
+  unsigned int planeCode( unsigned int hit ) const { return m_planeCode[hit]; }
+  unsigned int zone( unsigned int hit )      const { return m_zone[hit]; }
+  float dxDy( unsigned int hit )      const { return m_zoneDxDy[m_zone[hit]]; }
+  float dzDy( unsigned int hit )      const { return m_zoneDzDy[m_zone[hit]]; }
+  PrHit* hit( unsigned int hit )      const { return m_hits[hit]; }
+
+  /// x of all hits, contiguous
+  const float* xArray() const { return m_x.data(); }
+
+  /// Index of the first hit of the zone with x >= xMin
+  unsigned int lowerBoundX( unsigned int zone, float xMin ) const {
+    const float* xs = m_x.data() + begin( zone );
+    return begin( zone ) + m_buckets[zone].lowerBound( xMin, end( zone ) - begin( zone ), [xs]( unsigned int i ) { return xs[i]; } );
+  }
+
+  /// Call f( index ) for each hit with this LHCbID
+  template <typename F>
+  void forEachHit( LHCb::LHCbID id, F f ) const { m_idMap.forEach( id.lhcbID(), f ); }
+
+  /// Class to compare x positions of hits given by index
+  class LowerByX {
+  public:
+    LowerByX( const PrSeedingHitStore& store ) : m_store( store ) {}
+    bool operator() ( unsigned int lhs, unsigned int rhs ) const { return m_store.x( lhs ) < m_store.x( rhs ); }
+  private:
+    const PrSeedingHitStore& m_store;
+  };
+
+private:
+  std::vector<unsigned int>  m_begin;
+  std::vector<float>         m_zoneDxDy;
+  std::vector<float>         m_zoneDzDy;
+
+  std::vector<float>         m_x;
+  std::vector<float>         m_z;
+  std::vector<float>         m_w;
+  std::vector<unsigned int>  m_id;
+  std::vector<unsigned char> m_planeCode;
+  std::vector<unsigned char> m_zone;
+  std::vector<PrHit*>        m_hits;
+  PrSeedingHitIdMap          m_idMap;
+  float                      m_bucketWidth;
+  std::vector<PrSeedingXBuckets> m_buckets;
+};
+#endif // PRSEEDINGHITSTORE_H
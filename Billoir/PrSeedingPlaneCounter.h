@@ -0,0 +1,60 @@
+#ifndef PRSEEDINGPLANECOUNTER_H
+#define PRSEEDINGPLANECOUNTER_H 1
+
+// Include files
+#include <algorithm>
+
+#include "PrSeedingStereoHit.h"
+
+/** @class PrSeedingPlaneCounter PrSeedingPlaneCounter.h
+ *  Count the number of different planes in a list of stereo hits,
+ *  as PrPlaneCounter does for PrHits.
+ *
+ *  The planes with hits are the bits of a mask, and nbDifferent() is its popcount. When the
+ *  list given to set() overlaps the previous one, as in a sliding window, only the hits
+ *  which entered or left it are counted.
+ */
+class PrSeedingPlaneCounter {
+public:
+  PrSeedingPlaneCounter() : m_valid( false ), m_mask( 0 ) {
+    std::fill( m_planeList, m_planeList + nPlanes, 0 );
+  }
+
+  void set( PrSeedingStereoHits::const_iterator itBeg, PrSeedingStereoHits::const_iterator itEnd ) {
+    if ( !m_valid || itBeg < m_begin || m_end < itBeg ) {
+      m_mask = 0;
+      std::fill( m_planeList, m_planeList + nPlanes, 0 );
+      m_begin = m_end = itBeg;
+      m_valid = true;
+    }
+    for ( ; itBeg != m_begin; ++m_begin ) remove( (*m_begin).planeCode );
+    for ( ; m_end < itEnd; ++m_end ) add( (*m_end).planeCode );
+    for ( ; itEnd < m_end; --m_end ) remove( (*( m_end - 1 )).planeCode );
+  }
+
+  unsigned int nbDifferent() const { return nbPlanes( m_mask ); }
+
+  /// Bit of the plane, for masks of planes
+  static unsigned int planeBit( unsigned int planeCode ) { return 1u << planeCode; }
+
+  /// Number of planes in a mask of planes
+  static unsigned int nbPlanes( unsigned int mask ) { return __builtin_popcount( mask ); }
+
+private:
+  enum { nPlanes = 12 };
+
+  void add( unsigned int planeCode ) {
+    if ( 0 == m_planeList[planeCode]++ ) m_mask |= planeBit( planeCode );
+  }
+
+  void remove( unsigned int planeCode ) {
+    if ( 0 == --m_planeList[planeCode] ) m_mask &= ~planeBit( planeCode );
+  }
+
+  bool                                m_valid;
+  PrSeedingStereoHits::const_iterator m_begin;  ///< hits counted: [m_begin, m_end)
+  PrSeedingStereoHits::const_iterator m_end;
+  unsigned int                        m_mask;
+  int                                 m_planeList[nPlanes];
+};
+#endif // PRSEEDINGPLANECOUNTER_H
@@ -0,0 +1,79 @@
+#ifndef PRSEEDINGPOOL_H
+#define PRSEEDINGPOOL_H 1
+
+// Include files
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/** @class PrSeedingPool PrSeedingPool.h
+ *  Thread safe pool of objects kept from one event to the next for their memory, e.g. the
+ *  contexts of the events of the seeding. acquire() takes a free object, or makes a new one
+ *  with the factory if all are in use, so that concurrent events each get their own. The
+ *  Lease gives it back when it goes out of scope, also when an exception is thrown.
+ */
+template <typename T>
+class PrSeedingPool {
+public:
+  typedef std::function<T*()> Factory;
+
+  /// Object taken from the pool, given back by the destructor
+  class Lease {
+  public:
+    Lease( PrSeedingPool& pool, std::unique_ptr<T> object ) : m_pool( &pool ), m_object( std::move( object ) ) {}
+    Lease( Lease&& other ) : m_pool( other.m_pool ), m_object( std::move( other.m_object ) ) {}
+    ~Lease() { if ( m_object ) m_pool->release( std::move( m_object ) ); }
+
+    Lease( const Lease& ) = delete;
+    Lease& operator=( const Lease& ) = delete;
+
+    T& operator*()  const { return *m_object; }
+    T* operator->() const { return m_object.get(); }
+
+  private:
+    PrSeedingPool*     m_pool;
+    std::unique_ptr<T> m_object;
+  };
+
+  PrSeedingPool() {}
+
+  PrSeedingPool( const PrSeedingPool& ) = delete;
+  PrSeedingPool& operator=( const PrSeedingPool& ) = delete;
+
+  /// Forget the free objects, the next ones are made by factory. Not while objects are in use.
+  void reset( Factory factory ) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_free.clear();
+    m_factory = factory;
+  }
+
+  Lease acquire() {
+    {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      if ( !m_free.empty() ) {
+        std::unique_ptr<T> object = std::move( m_free.back() );
+        m_free.pop_back();
+        return Lease( *this, std::move( object ) );
+      }
+    }
+    return Lease( *this, std::unique_ptr<T>( m_factory() ) );
+  }
+
+  /// Number of objects waiting for the next events
+  unsigned int nFree() const {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_free.size();
+  }
+
+private:
+  void release( std::unique_ptr<T> object ) {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_free.push_back( std::move( object ) );
+  }
+
+  mutable std::mutex               m_mutex;
+  Factory                          m_factory;
+  std::vector<std::unique_ptr<T> > m_free;
+};
+#endif // PRSEEDINGPOOL_H
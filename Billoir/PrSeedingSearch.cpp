@@ -0,0 +1,866 @@
+// Include files
+#include <algorithm>
+#include <sstream>
+
+#include "tbb/parallel_for.h"
+#include "tbb/task_group.h"
+// local
+#include "PrSeedingSearch.h"
+#include "PrSeedingHitLists.h"
+#include "PrSeedingPlaneCounter.h"
+#include "PrSeedingSort.h"
+#include "PrSeedingStereoHit.h"
+#include "PrSeedingTier.h"
+
+//-----------------------------------------------------------------------------
+// Implementation file for class : PrSeedingSearch
+//
+// The search of PrSeedingXLayers, see there for the history
+//-----------------------------------------------------------------------------
+
+constexpr float PrSeedingSearch::curvatureTableTxMax;
+
+namespace {
+  /// Debug message of the monitor, only formatted if it wants them
+  template <typename Write>
+  void debugMessage( const PrSeedingSearch::Monitor* monitor, Write write ) {
+    if ( nullptr == monitor || !monitor->verbose() ) return;
+    std::ostringstream text;
+    write( text );
+    monitor->debug( text.str() );
+  }
+}
+
+//=============================================================================
+// Context of an event, for the settings of the search
+//=============================================================================
+PrSeedingSearch::EventContext::EventContext( const PrSeedingSearch& search ) : tier( 0 ) {
+  // -- The chunks are a few per thread, for the balance
+  const unsigned int threads = search.config().threadsPerHalf;
+  const unsigned int nChunks = 1 < threads ? 4 * threads : 0;
+  if ( 1 < threads ) taskArena.initialize( threads );
+  for ( unsigned int part = 0; 2 > part; ++part ) {
+    halves[part].batchFit.setLevel( search.simdLevel() );
+    for ( unsigned int c = 0; nChunks > c; ++c ) {
+      chunks[part].emplace_back( new SearchState );
+      chunks[part].back()->batchFit.setLevel( search.simdLevel() );
+    }
+  }
+}
+
+//=============================================================================
+// Settings and vector kernels
+//=============================================================================
+void PrSeedingSearch::configure( const Config& config, PrSeedingSimd::Level level ) {
+  m_config          = config;
+  m_simdLevel       = level;
+  m_findClosestHit  = PrSeedingClosestHit::select( level );
+  m_closestHitLanes = PrSeedingSimd::lanes( level );
+}
+
+//=========================================================================
+//  Search the seeds of an event, in its context
+//=========================================================================
+void PrSeedingSearch::search( const PrSeedingHitStore& hits, EventContext& event, const Monitor* monitor ) const {
+  // -- Cheaper configuration for the busy events, to stay within the latency target
+  const unsigned int multiplicity = hits.size();
+  event.tier = 0;
+  if ( 0. < m_config.latencyTarget ) {
+    event.tier = PrSeedingTier::choose( multiplicity, m_config.latencyScale, m_config.latencyTarget );
+    debugMessage( monitor, [&]( std::ostream& text ) { text << multiplicity << " hits, tier " << event.tier; } );
+  }
+
+  // -- Lower and upper half. They only read and set the used flags of their own hits, each through
+  //    its view of the used flags of the event, which are merged back when both are done: the
+  //    result does not depend on the order in which they run.
+  event.halves[0].usedHits = event.usedHits.view();
+  event.halves[1].usedHits = event.usedHits.view();
+  if ( m_config.concurrentHalves && nullptr == monitor ) {
+    tbb::task_group tasks;
+    tasks.run( [this, &hits, &event]() { searchHalf( hits, event, 1, nullptr ); } );
+    searchHalf( hits, event, 0, nullptr );
+    tasks.wait();
+  } else {
+    for ( unsigned int part= 0; 2 > part; ++part ) {
+      if ( monitor ) monitor->startStep( XProjections );
+      findXProjections2( hits, event, part, monitor );
+      if ( monitor ) {
+        monitor->stopStep( XProjections );
+        monitor->startStep( Stereo );
+      }
+      if ( ! m_config.xOnly ) addStereo2( hits, event, part, monitor );
+      if ( monitor ) monitor->stopStep( Stereo );
+    }
+  }
+  event.usedHits.merge( event.halves[0].usedHits );
+  event.usedHits.merge( event.halves[1].usedHits );
+
+  event.halves[0].addCounts( event.halves[1] );
+}
+
+//=========================================================================
+//  Fit the track, return OK if fit sucecssfull
+//=========================================================================
+bool PrSeedingSearch::fitTrack( const PrSeedingHitStore& hits, PrSeedCandidate& track,
+                                const PrSeedingBatchFit::Moments& moments, unsigned int& worst ) const {
+  return PrSeedingBatchFit::fitTrack( hits, m_geometry.zRef(), m_config.maxChi2InTrack, track, moments, worst );
+}
+
+//=========================================================================
+//  Run f on the chunks of [0, n) of a half, as tasks of the task arena of the event
+//=========================================================================
+template <typename F>
+void PrSeedingSearch::runChunks( EventContext& event, unsigned int part, unsigned int n, const F& f ) const {
+  std::vector<std::unique_ptr<SearchState> >& chunks = event.chunks[part];
+  const unsigned int nChunks = chunks.size();
+  event.taskArena.execute( [&]() {
+    tbb::parallel_for( 0u, nChunks, [&]( unsigned int c ) {
+      chunks[c]->reset();
+      f( *chunks[c], c * n / nChunks, ( c + 1 ) * n / nChunks );
+    } );
+  } );
+}
+
+//=========================================================================
+//  Search the tracks of one half of the detector
+//=========================================================================
+void PrSeedingSearch::searchHalf( const PrSeedingHitStore& hits, EventContext& event, unsigned int part,
+                                  const Monitor* monitor ) const {
+  findXProjections2( hits, event, part, monitor );
+  if ( ! m_config.xOnly ) addStereo2( hits, event, part, monitor );
+}
+
+//=========================================================================
+//  Remove the worst hit and refit.
+//=========================================================================
+bool PrSeedingSearch::removeWorstAndRefit ( const PrSeedingHitStore& hits, PrSeedCandidate& track,
+                                            PrSeedingBatchFit::Moments& moments, unsigned int& worst ) const {
+  moments.remove( hits, m_geometry.zRef(), track.hits()[worst] );
+  track.hits().erase( track.hits().begin() + worst );
+  return fitTrack( hits, track, moments, worst );
+}
+//=========================================================================
+//  Remove the worst hits until the fit is good, within the budget
+//=========================================================================
+bool PrSeedingSearch::removeOutliers ( const PrSeedingHitStore& hits, PrSeedCandidate& track, unsigned int worst,
+                                       unsigned int minHits, unsigned int maxRemovals, SearchState& state ) const {
+  PrSeedingBatchFit::Moments moments( hits, m_geometry.zRef(), track );
+  for ( unsigned int nRemoved = 0; maxRemovals > nRemoved; ++nRemoved ) {
+    if ( track.hits().size() <= minHits ) {
+      ++state.nBelowMinHits;
+      return false;
+    }
+    ++state.nRemovals;
+    if ( removeWorstAndRefit( hits, track, moments, worst ) ) return true;
+  }
+  ++state.nRemovalBudgetExhausted;
+  return false;
+}
+
+//=========================================================================
+//  Set the chi2 of the track
+//=========================================================================
+PRSEEDING_NO_CONTRACT
+void PrSeedingSearch::setChi2 ( const PrSeedingHitStore& hits, PrSeedCandidate& track ) const {
+  float chi2 = 0.;
+  int   nDoF = -3;  // Fitted a parabola
+  bool hasStereo = false;
+  for ( PrHitIndices::const_iterator itH = track.hits().begin(); track.hits().end() != itH; ++itH ) {
+    float d = track.distance( hits, *itH );
+    if ( hits.dxDy( *itH ) != 0 ) hasStereo = true;
+    float w = hits.w( *itH );
+    chi2 += w * d * d;
+    nDoF += 1;
+  }
+  if ( hasStereo ) nDoF -= 2;
+  track.setChi2( chi2, nDoF );
+}
+
+//=========================================================================
+//  Find the x projections from the first hits of some groups of doublets
+//=========================================================================
+void PrSeedingSearch::findXProjectionsInGroups( const PrSeedingHitStore& hitStore, unsigned int tierOfEvent,
+                                                unsigned int part, unsigned int iCase,
+                                                const PrSeedingDoublets& doublets, unsigned int gBegin, unsigned int gEnd,
+                                                SearchState& state, const Monitor* monitor ) const {
+  const PrHitIndices::allocator_type alloc( &state.arena );
+
+  // -- Scratch containers, reused for all doublets so that their memory is allocated once
+  PrHitIndices parabolaSeedHits( alloc );
+  PrHitIndices xHits( alloc );
+  PrSeedingHitLists xHitsLists( alloc );
+  std::vector<PrSeedCandidate, PrSeedingArena::Allocator<PrSeedCandidate> > fitTracks( alloc );
+  parabolaSeedHits.reserve( 16 );
+  xHits.reserve( 16 );
+  xHitsLists.reserve( m_config.maxParabolaSeedHits, m_config.maxParabolaSeedHits * ( m_geometry.nZones() + 2 ) );
+  fitTracks.reserve( m_config.maxParabolaSeedHits );
+
+  // -- Parabola hypotheses of a doublet, and the wide windows of the current zone
+  typedef std::vector<float, PrSeedingArena::Allocator<float> > Floats;
+  Floats parA( m_config.maxParabolaSeedHits, 0., alloc );
+  Floats parB( m_config.maxParabolaSeedHits, 0., alloc );
+  Floats parC( m_config.maxParabolaSeedHits, 0., alloc );
+  Floats hypXAtZ( m_config.maxParabolaSeedHits, 0., alloc );
+  Floats hypXMin( m_config.maxParabolaSeedHits, 0., alloc );
+  Floats hypXMax( m_config.maxParabolaSeedHits, 0., alloc );
+  std::vector<int, PrSeedingArena::Allocator<int> > hypBest( m_config.maxParabolaSeedHits, -1, alloc );
+  PrHitIndices hypFirst( m_config.maxParabolaSeedHits, 0, alloc );
+  PrHitIndices hypIndex( m_config.maxParabolaSeedHits, 0, alloc );
+  // -- Closest hits of hypothesis i: hypHits[i*nXZones, i*nXZones + hypNHits[i]), at most one per zone
+  const unsigned int nXZones = m_geometry.nZones();
+  PrHitIndices hypHits( m_config.maxParabolaSeedHits * nXZones, 0, alloc );
+  PrHitIndices hypNHits( m_config.maxParabolaSeedHits, 0, alloc );
+
+  // -- Candidates waiting for their fit, with the slope of their doublet. They are fitted per doublet,
+  //    or per first hit with MaxXCandidatesPerFirstHit, which then only fits the best ones
+  Floats poolTx( alloc );
+  Floats poolResidual( alloc );   ///< mean distance of the hits to the parabola of the candidate
+  Floats listResidual( alloc );   ///< same, for the lists of xHitsLists in their insertion order
+  PrHitIndices beam( alloc );
+  unsigned int nPool = 0;
+
+  auto fitPool = [&]( unsigned int nFit ) {
+    state.batchFit.fit( hitStore, m_geometry.zRef(), m_config.maxChi2InTrack, fitTracks.data(), nFit );
+
+    for( unsigned int k = 0; k < nFit; ++k ){
+
+      PrSeedCandidate& temp = fitTracks[k];
+      bool OK = state.batchFit.ok( k );
+      // -- Candidates below MinXPlanes are rejected below, the removals stop there
+      if ( !OK ) OK = removeOutliers( hitStore, temp, state.batchFit.worst( k ), m_config.minXPlanes,
+                                      m_config.maxXFitRemovals, state );
+      setChi2( hitStore, temp );
+      // ---------------------------------------
+
+      float maxChi2 = m_config.maxChi2PerDoF + 6*poolTx[k]*poolTx[k];
+
+
+      if ( OK &&
+           temp.hits().size() >= m_config.minXPlanes &&
+           temp.chi2PerDoF()  < maxChi2   ) {
+        if ( temp.hits().size() == 6 ) {
+          for ( PrHitIndices::const_iterator itH = temp.hits().begin(); temp.hits().end() != itH; ++ itH) {
+            state.usedHits.setUsed( *itH );
+          }
+
+
+        }
+
+        state.xCandidates.push_back( temp );
+      }
+      // -------------------------------------
+    }
+    nPool = 0;
+    poolTx.clear();
+    poolResidual.clear();
+  };
+
+  const PrSeedingTier& tier = PrSeedingTier::get( tierOfEvent );
+  const float tolXSup = tier.tolXSup( m_config.tolXSup );
+
+  const unsigned int firstZone = m_geometry.firstZone( part, iCase );
+  const unsigned int lastZone  = m_geometry.lastZone( part, iCase );
+  const float zFirst = m_geometry.z( firstZone );
+  const float zLast  = m_geometry.z( lastZone );
+  const PrSeedingGeometry::Zones& xZones = m_geometry.xZones( part, iCase );
+
+  for ( unsigned int iG = gBegin; gEnd != iG; ++iG ) {
+
+    const unsigned int iF = doublets.firstHit( iG );
+    if ( 0 != iCase && state.usedHits.isUsed( iF ) ) continue;
+
+    if ( monitor ) {
+      float minXl, maxXl;
+      PrSeedingDoublets::lastWindow( hitStore.x( iF ), zFirst, zLast, m_config.maxIpAtZero, minXl, maxXl );
+      monitor->histogram(minXl, "minXl", "minXl", -6000, 6000, 100);
+      monitor->histogram(maxXl, "maxXl", "maxXl", -6000, 6000, 100);
+      if ( monitor->matchKey( hitStore.hit( iF ) ) ) {
+        std::ostringstream text;
+        text << "Search from " << minXl << " to " << maxXl;
+        monitor->info( text.str() );
+      }
+    }
+
+    for ( unsigned int iD = doublets.begin( iG ); doublets.end( iG ) != iD; ++iD ) {
+
+      const unsigned int iL = doublets.lastHit( iD );
+      if ( 0 != iCase && state.usedHits.isUsed( iL ) ) continue;
+
+
+      float tx = doublets.tx( iD );
+      float x0 = doublets.x0( iD );
+
+      if ( monitor ) {
+        monitor->histogram(tx, "tx", "tx", -1.,1., 100 );
+        monitor->histogram(x0, "x0", "x0", 0., 6000., 100.);
+      }
+      parabolaSeedHits.clear();
+
+      // -- loop over first two x zones
+      // --------------------------------------------------------------------------------
+      unsigned int counter = 0;
+      bool skip = true;
+      if( iCase != 0 ) skip = false;
+	for ( PrSeedingGeometry::Zones::const_iterator itZ = xZones.begin(); xZones.end() != itZ; ++itZ ) {
+	  ++counter;
+        // -- to make sure, in case = 0, only x layers of the 2nd T station are used
+        if(skip){
+          skip = false;
+          continue;
+        }
+	  if( iCase == 0){
+          if(counter > 3) break;
+        }else{
+          if(counter > 2) break;
+        }
+
+	  float xP   = x0 + m_geometry.z( *itZ ) * tx;
+        float xMax = xP + 2*fabs(tx)*tolXSup + 1.5;
+        float xMin = xP - m_config.tolXInf;
+
+        if ( monitor ) {
+	    monitor->histogram(xP, "xP_x0pos", "xP_x0pos", -10000., 10000., 100);
+	    monitor->histogram(xMax, "xMax_x0pos", "xMax_x0pos", -10000., 10000., 100);
+	    monitor->histogram(xMin, "xMin_x0pos", "xMax_x0pos", -10000., 10000., 100);
+        }
+
+
+        if ( x0 < 0 ) {
+          xMin = xP - 2*fabs(tx)*tolXSup - 1.5;
+          xMax = xP + m_config.tolXInf;
+          if ( monitor ) {
+	      monitor->histogram(xP, "xP_x0neg", "xP_x0neg", -10000., 10000., 100);
+	      monitor->histogram(xMax, "xMax_x0neg", "xMax_x0neg", -10000., 10000., 100);
+	      monitor->histogram(xMin, "xMin_x0neg", "xMax_x0neg", -10000., 10000., 100);
+          }
+
+        }
+
+        // -- The deviation from the line is at most the one expected for the curvature of this
+        // -- tx and x0, on the side of x0, where the window above is open
+        if ( m_config.useCurvatureTable ) {
+          const float lever = ( m_geometry.z( *itZ ) - zFirst ) * ( zLast - m_geometry.z( *itZ ) );
+          float curvature, spread;
+          m_curvatureTable.lookup( tx, x0, curvature, spread );
+          const float dev  = ( x0 < 0 ? -curvature : curvature ) * lever;
+          const float half = spread * lever + m_config.curvatureTolerance;
+          xMin = std::max( xMin, xP + dev - half );
+          xMax = std::min( xMax, xP + dev + half );
+        }
+
+        const unsigned int zEnd = hitStore.end( *itZ );
+        for ( unsigned int iH = hitStore.lowerBoundX( *itZ, xMin ); zEnd != iH; ++iH ) {
+          if ( hitStore.x( iH ) > xMax ) break;
+          parabolaSeedHits.push_back( iH );
+        }
+      }
+      // --------------------------------------------------------------------------------
+
+      debugMessage( monitor, [&]( std::ostream& text ) {
+          text << "We have " << parabolaSeedHits.size() << " hits to seed the parabolas"; } );
+      if ( monitor ) monitor->histogram(parabolaSeedHits.size() , "HitsToSeedParabolas", "HitsToSeedParabolas", 0., 20., 20 );
+
+
+      xHitsLists.clear();
+      listResidual.clear();
+
+
+      // -- float xP   = x0 + (*itZ)->z() * tx;
+      // -- Alles klar, Herr Kommissar?
+      // -- The power of Lambda functions!
+      // -- Idea is to reduce ghosts in very busy events and prefer the high momentum tracks
+      // -- For this, the seedHits are storted according to their distance to the linear extrapolation
+      // -- so that the ones with the least distance can be chosen in the end
+      const PrSeedingHitStore& store = hitStore;
+      PrSeedingSort::radixSortByKey( parabolaSeedHits.begin(), parabolaSeedHits.end(),
+                 [x0,tx,&store](unsigned int hit)->float{ return fabs(store.x(hit) - (x0+store.z(hit)*tx)); },
+                 state.arena );
+
+
+      unsigned int maxParabolaSeedHits = tier.maxParabolaSeedHits( m_config.maxParabolaSeedHits );
+      if( parabolaSeedHits.size() < maxParabolaSeedHits){
+        maxParabolaSeedHits = parabolaSeedHits.size();
+      }
+
+
+      // -- formula is: x = a*dz*dz + b*dz + c = x, with dz = z - zRef
+      for(unsigned int i = 0; i < maxParabolaSeedHits; ++i){
+        parA[i] = 0;
+        parB[i] = 0;
+        parC[i] = 0;
+        solveParabola( hitStore, iF, parabolaSeedHits[i], iL, parA[i], parB[i], parC[i] );
+        hypNHits[i] = 0;
+
+        debugMessage( monitor, [&]( std::ostream& text ) {
+            text << "parabola equation: x = " << parA[i] << "*z^2 + " << parB[i] << "*z + " << parC[i]; } );
+      }
+
+      // -- Only use one hit per layer, which is closest to the parabola! All parabolas are searched in one pass
+      if ( 0 == maxParabolaSeedHits ) continue;
+      for ( PrSeedingGeometry::Zones::const_iterator itZ = xZones.begin(); xZones.end() != itZ; ++itZ ) {
+
+        float dz = m_geometry.dz( *itZ );
+        float xP = x0 + m_geometry.z( *itZ ) * tx;
+
+        const unsigned int zEnd = hitStore.end( *itZ );
+        unsigned int nWide = 0;
+
+        for(unsigned int i = 0; i < maxParabolaSeedHits; ++i){
+          float xAtZ = parA[i]*dz*dz + parB[i]*dz + parC[i];
+          float xMax = xAtZ + fabs(tx)*2.0 + 0.5;
+          float xMin = xAtZ - fabs(tx)*2.0 - 0.5;
+
+          debugMessage( monitor, [&]( std::ostream& text ) {
+              text << "x prediction (linear): " << xP <<  "x prediction (parabola): " << xAtZ; } );
+
+          const unsigned int firstHit = hitStore.lowerBoundX( *itZ, xMin );
+
+          // -- A wide window is left to the vector search, which reads it once for all hypotheses
+          if ( m_findClosestHit && zEnd >= firstHit + m_closestHitLanes &&
+               hitStore.x( firstHit + m_closestHitLanes - 1 ) <= xMax ) {
+            hypIndex[nWide] = i;
+            hypFirst[nWide] = firstHit;
+            hypXAtZ[nWide]  = xAtZ;
+            hypXMin[nWide]  = xMin;
+            hypXMax[nWide]  = xMax;
+            ++nWide;
+            continue;
+          }
+
+          const int best = PrSeedingClosestHit::scan( hitStore.xArray(), firstHit, zEnd, xAtZ, xMax, 10.0 );
+          if( best != -1 ) hypHits[i*nXZones + hypNHits[i]++] = best;
+        }
+
+        if ( 0 == nWide ) continue;
+        m_findClosestHit( hitStore.xArray(), hypFirst.data(), zEnd, nWide,
+                          hypXAtZ.data(), hypXMin.data(), hypXMax.data(), 10.0, hypBest.data() );
+
+        for(unsigned int k = 0; k < nWide; ++k){
+          const unsigned int i = hypIndex[k];
+          if( hypBest[k] != -1 ) hypHits[i*nXZones + hypNHits[i]++] = hypBest[k];
+        }
+      }
+
+      for(unsigned int i = 0; i < maxParabolaSeedHits; ++i){
+
+        xHits.assign( hypHits.begin() + i*nXZones, hypHits.begin() + i*nXZones + hypNHits[i] );
+        xHits.push_back( iF );
+        xHits.push_back( iL );
+
+
+        if( xHits.size() < 5) continue;
+        PrSeedingSort::stableSort(xHits.begin(), xHits.end(), PrSeedingHitStore::LowerByX( hitStore ), state.arena);
+
+
+        // -- Lists already found for this doublet are recognised by their fingerprint
+        if ( xHitsLists.insert( xHits.begin(), xHits.end() ) && 0 != m_config.maxXCandidatesPerFirstHit ) {
+          float residual = 0.;
+          for ( PrHitIndices::const_iterator itH = xHits.begin(); xHits.end() != itH; ++itH ) {
+            const float dz = hitStore.z( *itH ) - m_geometry.zRef();
+            residual += fabs( hitStore.x( *itH ) - ( parA[i]*dz*dz + parB[i]*dz + parC[i] ) );
+          }
+          listResidual.push_back( residual / xHits.size() );
+        }
+      }
+
+      // -- The lists are distinct; with more than two, they are fitted in lexicographic order
+      const unsigned int nLists = xHitsLists.size();
+      debugMessage( monitor, [&]( std::ostream& text ) { text << "xHitsLists size: " << nLists; } );
+      if( nLists > 2) xHitsLists.sort( state.arena );
+
+
+
+      // -- The lists with less than MinXPlanes planes would be rejected after the fit, they are not fitted
+      for( unsigned int k = 0; k < nLists; ++k ){
+        unsigned int planes = 0;
+        for ( const unsigned int* itH = xHitsLists.begin( k ); xHitsLists.end( k ) != itH; ++itH ) {
+          planes |= PrSeedingPlaneCounter::planeBit( hitStore.planeCode( *itH ) );
+        }
+        if ( PrSeedingPlaneCounter::nbPlanes( planes ) < m_config.minXPlanes ) continue;
+        if ( fitTracks.size() == nPool ) fitTracks.push_back( PrSeedCandidate( part, m_geometry.zRef(), alloc ) );
+        fitTracks[nPool].init();
+        fitTracks[nPool++].hits().assign( xHitsLists.begin( k ), xHitsLists.end( k ) );
+        poolTx.push_back( tx );
+        if ( 0 != m_config.maxXCandidatesPerFirstHit ) poolResidual.push_back( listResidual[xHitsLists.inserted( k )] );
+      }
+
+      // -- All lists of the doublet are fitted at once
+      if ( 0 == m_config.maxXCandidatesPerFirstHit ) fitPool( nPool );
+    }
+
+    // -- Only the best candidates of the first hit are fitted: the ones with most hits, then the ones
+    //    closest to their parabola. They are fitted in the order in which they were found.
+    if ( 0 == nPool ) continue;
+    const unsigned int maxPool = m_config.maxXCandidatesPerFirstHit;
+    if ( maxPool < nPool ) {
+      beam.resize( nPool );
+      for ( unsigned int k = 0; nPool > k; ++k ) beam[k] = k;
+      PrSeedingSort::stableSort( beam.begin(), beam.end(),
+                                 [&fitTracks, &poolResidual]( unsigned int lhs, unsigned int rhs ) -> bool {
+                                   const unsigned int nLhs = fitTracks[lhs].hits().size();
+                                   const unsigned int nRhs = fitTracks[rhs].hits().size();
+                                   if ( nLhs != nRhs ) return nLhs > nRhs;
+                                   return poolResidual[lhs] < poolResidual[rhs];
+                                 },
+                                 state.arena );
+      beam.resize( maxPool );
+      std::sort( beam.begin(), beam.end() );
+      for ( unsigned int k = 0; maxPool > k; ++k ) {
+        if ( beam[k] == k ) continue;
+        std::swap( fitTracks[k], fitTracks[beam[k]] );
+        poolTx[k] = poolTx[beam[k]];
+      }
+      state.nBeamPruned += nPool - maxPool;
+      nPool = maxPool;
+    }
+    fitPool( nPool );
+  }
+}
+
+//=========================================================================
+// modified method to find the x projections
+//=========================================================================
+void PrSeedingSearch::findXProjections2( const PrSeedingHitStore& hitStore, EventContext& event, unsigned int part,
+                                         const Monitor* monitor ) const {
+  SearchState& half = event.halves[part];
+  half.xCandidates.clear();
+  const PrHitIndices::allocator_type alloc( &half.arena );
+  PrSeedingDoublets doublets( alloc );
+
+  std::vector<std::unique_ptr<SearchState> >& chunks = event.chunks[part];
+  const unsigned int nChunks = chunks.size();
+  const bool parallel = 1 < nChunks && !( monitor && monitor->serial() );
+
+  const PrSeedingTier& tier = PrSeedingTier::get( event.tier );
+
+  for ( unsigned int iCase = 0 ; tier.nCases > iCase ; ++iCase ) {
+    const unsigned int firstZone = m_geometry.firstZone( part, iCase );
+    const unsigned int lastZone  = m_geometry.lastZone( part, iCase );
+    const float zFirst = m_geometry.z( firstZone );
+    const float zLast  = m_geometry.z( lastZone );
+
+    if ( monitor ) {
+      monitor->histogram(zLast / zFirst, "zRatio", "zRatio", 0., 2, 100);
+      monitor->histogram(hitStore.end( firstZone ) - hitStore.begin( firstZone ), "NumberOfHitsInFirstZone","NumberOfHitsInFirstZone", 0., 600., 100);
+      monitor->histogram(hitStore.end( lastZone ) - hitStore.begin( lastZone ), "NumberOfHitsInLastZone","NumberOfHitsInLastZone", 0., 600., 100);
+    }
+
+    // -- All pairs of the case first, with their lines. The hits used since are skipped below.
+    doublets.build( hitStore, 0 != iCase ? &half.usedHits : nullptr, firstZone, lastZone, zFirst, zLast, m_config.maxIpAtZero );
+
+    const unsigned int nGroups = doublets.nGroups();
+    if ( !parallel || nGroups < nChunks || ( 0 != iCase && !m_config.parallelAllCases ) ) {
+      findXProjectionsInGroups( hitStore, event.tier, part, iCase, doublets, 0, nGroups, half, monitor );
+      continue;
+    }
+
+    // -- The first hits, in x order, are cut in chunks searched as tasks, each with its own candidates
+    //    and view of the used flags. The first case does not read the flags: the candidates of the chunks,
+    //    in their order, are the ones of the serial search. In the other cases, a chunk does not see the
+    //    hits used by the chunks before it.
+    runChunks( event, part, nGroups, [&]( SearchState& chunk, unsigned int gBegin, unsigned int gEnd ) {
+      chunk.usedHits = half.usedHits.view();
+      findXProjectionsInGroups( hitStore, event.tier, part, iCase, doublets, gBegin, gEnd, chunk, monitor );
+    } );
+    for ( unsigned int c = 0; nChunks > c; ++c ) {
+      const SearchState& chunk = *chunks[c];
+      half.appendCopies( chunk.xCandidates, half.xCandidates );
+      half.usedHits.merge( chunk.usedHits );
+      half.addCounts( chunk );
+    }
+  }
+
+
+  PrSeedingSort::stableSortByDecreasingKey( half.xCandidates, half.sortScratch,
+                                            [](const PrSeedCandidate& track)->unsigned int{ return track.hits().size(); } );
+
+  //====================================================================
+  // Remove clones, i.e. share more than 2 hits
+  //====================================================================
+  // -- The merge below can only find hits which are really common, and an LHCbID is one hit of the store:
+  //    only the candidates with at least 3 hits in common with itT1 can be its clones. They are found
+  //    with the hit -> candidates index, then compared in the same order as all the candidates were
+  half.candidateIndex.build( half.xCandidates, hitStore.size() );
+  PrHitIndices nShared( half.xCandidates.size(), 0, alloc );
+  PrHitIndices sharing( alloc );
+
+  for ( PrSeedCandidates::iterator itT1 = half.xCandidates.begin(); half.xCandidates.end() !=itT1; ++itT1 ) {
+    if ( !(*itT1).valid() ) continue;
+    if ( (*itT1).hits().size() != 6 ) {
+      int nUsed = 0;
+      for ( PrHitIndices::const_iterator itH = (*itT1).hits().begin(); (*itT1).hits().end() != itH; ++ itH) {
+        if ( half.usedHits.isUsed( *itH ) ) ++nUsed;
+      }
+      if ( 1 < nUsed ) {
+        (*itT1).setValid( false );
+        continue;
+      }
+    }
+
+    const unsigned int i1 = itT1 - half.xCandidates.begin();
+    sharing.clear();
+    for ( PrHitIndices::const_iterator itH = (*itT1).hits().begin(); (*itT1).hits().end() != itH; ++ itH) {
+      for ( const unsigned int* itC = half.candidateIndex.begin( *itH ); half.candidateIndex.end( *itH ) != itC; ++itC ) {
+        if ( i1 < *itC && 0 == nShared[*itC]++ ) sharing.push_back( *itC );
+      }
+    }
+    unsigned int nSharing = 0;
+    for ( PrHitIndices::const_iterator itC = sharing.begin(); sharing.end() != itC; ++itC ) {
+      if ( 2 < nShared[*itC] ) sharing[nSharing++] = *itC;
+      nShared[*itC] = 0;
+    }
+    std::sort( sharing.begin(), sharing.begin() + nSharing );
+
+    for ( PrHitIndices::const_iterator itC = sharing.begin(); sharing.begin() + nSharing != itC; ++itC ) {
+      PrSeedCandidates::iterator itT2 = half.xCandidates.begin() + *itC;
+      if ( !(*itT2).valid() ) continue;
+      int nCommon = 0;
+      PrHitIndices::const_iterator itH1 = (*itT1).hits().begin();
+      PrHitIndices::const_iterator itH2 = (*itT2).hits().begin();
+
+      PrHitIndices::const_iterator itEnd1 = (*itT1).hits().end();
+      PrHitIndices::const_iterator itEnd2 = (*itT2).hits().end();
+
+      while ( itH1 != itEnd1 && itH2 != itEnd2 ) {
+        if ( hitStore.id( *itH1 ) == hitStore.id( *itH2 ) ) {
+          ++nCommon;
+          ++itH1;
+          ++itH2;
+        } else if ( hitStore.id( *itH1 ) < hitStore.id( *itH2 ) ) {
+          ++itH1;
+        } else {
+          ++itH2;
+        }
+      }
+      if ( nCommon > 2 ) {
+        if ( (*itT1).hits().size() > (*itT2).hits().size() ) {
+          (*itT2).setValid( false );
+        } else if ( (*itT1).hits().size() < (*itT2).hits().size() ) {
+          (*itT1).setValid( false );
+        } else if ( (*itT1).chi2PerDoF() < (*itT2).chi2PerDoF() ) {
+          (*itT2).setValid( false );
+        } else {
+          (*itT1).setValid( false );
+        }
+      }
+    }
+    if ( m_config.xOnly ) half.trackCandidates.push_back( *itT1 );
+  }
+}
+//=========================================================================
+// Modified version of adding the stereo layers
+//=========================================================================
+void PrSeedingSearch::addStereo2( const PrSeedingHitStore& hitStore, EventContext& event, unsigned int part,
+                                  const Monitor* monitor ) const {
+  SearchState& half = event.halves[part];
+  const unsigned int nX = half.xCandidates.size();
+  std::vector<std::unique_ptr<SearchState> >& chunks = event.chunks[part];
+  if ( 2 > chunks.size() || nX < chunks.size() || ( monitor && monitor->serial() ) ) {
+    addStereoToProjections( hitStore, part, half.xCandidates, 0, nX, half );
+    return;
+  }
+
+  // -- The x projections are independent: they are cut in chunks completed as tasks, whose
+  //    tracks are concatenated in the order of the chunks, as the serial loop finds them
+  runChunks( event, part, nX, [&]( SearchState& chunk, unsigned int kBegin, unsigned int kEnd ) {
+    addStereoToProjections( hitStore, part, half.xCandidates, kBegin, kEnd, chunk );
+  } );
+  for ( unsigned int c = 0; chunks.size() > c; ++c ) {
+    half.appendCopies( chunks[c]->trackCandidates, half.trackCandidates );
+    half.addCounts( *chunks[c] );
+  }
+}
+
+//=========================================================================
+//  Add the stereo hits to the x projections [kBegin, kEnd)
+//=========================================================================
+void PrSeedingSearch::addStereoToProjections( const PrSeedingHitStore& hitStore, unsigned int part,
+                                              const PrSeedCandidates& xCandidates,
+                                              unsigned int kBegin, unsigned int kEnd, SearchState& state ) const {
+  const PrHitIndices::allocator_type alloc( &state.arena );
+  typedef std::vector<PrSeedCandidate, PrSeedingArena::Allocator<PrSeedCandidate> > ScratchCandidates;
+
+  const PrSeedingGeometry::Zones& stereoZones = m_geometry.stereoZones( part );
+
+  // -- Stereo hits of all valid x projections, sorted by coord: those of the projection k
+  // -- are in [stereoBegin[k], stereoBegin[k+1])
+  PrSeedingStereoHits stereoHits( alloc );
+  PrHitIndices xProjections( alloc );
+  PrHitIndices stereoBegin( alloc );
+  stereoHits.reserve( 64 * ( kEnd - kBegin ) );
+  xProjections.reserve( kEnd - kBegin );
+  stereoBegin.reserve( kEnd - kBegin + 1 );
+
+  for ( PrSeedCandidates::const_iterator itT = xCandidates.begin() + kBegin; xCandidates.begin() + kEnd != itT; ++itT ) {
+    if ( !(*itT).valid() ) continue;
+    xProjections.push_back( itT - xCandidates.begin() );
+    stereoBegin.push_back( stereoHits.size() );
+
+    for ( PrSeedingGeometry::Zones::const_iterator itZ = stereoZones.begin(); stereoZones.end() != itZ; ++itZ ) {
+      const unsigned int kk = *itZ;
+      float dxDy = m_geometry.dxDy( kk );
+      float zPlane = m_geometry.z( kk );
+
+      float xPred = (*itT).x( zPlane );
+
+      float xMin = xPred + 2500. * dxDy;
+      float xMax = xPred - 2500. * dxDy;
+
+      if ( xMin > xMax ) {
+        float tmp = xMax;
+        xMax = xMin;
+        xMin = tmp;
+      }
+
+
+      const unsigned int zEnd = hitStore.end( kk );
+      for ( unsigned int iH = hitStore.lowerBoundX( kk, xMin ); zEnd != iH; ++iH ) {
+
+        if ( hitStore.x( iH ) > xMax ) break;
+
+        const float coord = (hitStore.x( iH ) - xPred) / dxDy  / zPlane;
+
+        if ( 1 == part && coord < -0.005 ) continue;
+        if ( 0 == part && coord >  0.005 ) continue;
+
+        stereoHits.push_back( PrSeedingStereoHit( coord, iH, hitStore.planeCode( iH ) ) );
+      }
+    }
+    PrSeedingSort::radixSortByKey( stereoHits.begin() + stereoBegin.back(), stereoHits.end(),
+                                   []( const PrSeedingStereoHit& hit ) -> float { return hit.coord; }, state.arena );
+  }
+  stereoBegin.push_back( stereoHits.size() );
+
+  //== Each x projection slides a window over its stereo hits. The projections advance together:
+  //== at each round, the next window passing the cuts of every projection is fitted in one batch.
+  PrSeedingPlaneCounter plCount;
+  PrHitIndices position( stereoBegin.begin(), stereoBegin.end() - 1, alloc );
+  PrHitIndices active( alloc );
+  PrHitIndices fitOwner( alloc );
+  ScratchCandidates fitTracks( alloc );
+  // -- Best candidate of the projection k so far: kept[bestOf[k]], if bestOf[k] != noBest
+  const unsigned int noBest = xProjections.size();
+  PrHitIndices bestOf( xProjections.size(), noBest, alloc );
+  ScratchCandidates kept( alloc );
+  kept.reserve( xProjections.size() );
+  active.reserve( xProjections.size() );
+  fitOwner.reserve( xProjections.size() );
+  fitTracks.reserve( xProjections.size() );
+  for ( unsigned int k = 0; xProjections.size() > k; ++k ) active.push_back( k );
+
+  while ( !active.empty() ) {
+    unsigned int nFit    = 0;
+    unsigned int nActive = 0;
+    fitOwner.clear();
+    for ( PrHitIndices::const_iterator itK = active.begin(); active.end() != itK; ++itK ) {
+      const unsigned int k = *itK;
+      const PrSeedingStereoHits::const_iterator itLast = stereoHits.begin() + stereoBegin[k+1];
+      for ( unsigned int& iBeg = position[k]; stereoBegin[k+1] > iBeg + 5; ++iBeg ) {
+        PrSeedingStereoHits::const_iterator itBeg = stereoHits.begin() + iBeg;
+        PrSeedingStereoHits::const_iterator itEnd = itBeg + 5;
+
+        float tolTy = m_config.tolTyOffset + m_config.tolTySlope * fabs( (*itBeg).coord );
+
+        if ( (*(itEnd-1)).coord - (*itBeg).coord >= tolTy ) continue;
+        while( itEnd+1 < itLast &&
+               (*itEnd).coord - (*itBeg).coord < tolTy ) {
+          ++itEnd;
+        }
+
+        plCount.set( itBeg, itEnd );
+        if ( 4 >= plCount.nbDifferent() ) continue;
+
+        const PrSeedCandidate& xProj = xCandidates[ xProjections[k] ];
+        // -- The x projection may be in another arena, its hits are copied into the one of this state
+        if ( fitTracks.size() == nFit ) fitTracks.push_back( PrSeedCandidate( part, m_geometry.zRef(), alloc ) );
+        PrSeedCandidate& temp = fitTracks[nFit++];
+        temp = xProj;
+        for ( PrSeedingStereoHits::const_iterator itH = itBeg; itEnd != itH; ++itH ) temp.addHit( (*itH).hit );
+        fitOwner.push_back( k );
+        active[nActive++] = k;
+        break;
+      }
+    }
+    active.resize( nActive );
+
+    for ( unsigned int iFit = 0; 3 > iFit; ++iFit ) {
+      state.batchFit.fit( hitStore, m_geometry.zRef(), m_config.maxChi2InTrack, fitTracks.data(), nFit );
+    }
+
+    for ( unsigned int iFit = 0; nFit > iFit; ++iFit ) {
+      const unsigned int k = fitOwner[iFit];
+      PrSeedCandidate& temp = fitTracks[iFit];
+      bool ok = state.batchFit.ok( iFit );
+      unsigned int worst = state.batchFit.worst( iFit );
+
+      if ( !ok && temp.hits().size() > 10 ) {
+        PrSeedingBatchFit::Moments moments( hitStore, m_geometry.zRef(), temp );
+        while ( !ok && temp.hits().size() > 10 ) {
+          ok = removeWorstAndRefit( hitStore, temp, moments, worst );
+        }
+      }
+      if ( ok ) {
+        setChi2( hitStore, temp );
+
+        float maxChi2 = m_config.maxChi2PerDoF + 6*temp.xSlope(9000)*temp.xSlope(9000);
+
+        if ( temp.hits().size() > 9 ||
+             temp.chi2PerDoF() < maxChi2 ) {
+          //=== Keep the best for this input track: most hits, then smallest chi2, the later one on ties
+          if ( noBest == bestOf[k] ) {
+            bestOf[k] = kept.size();
+            kept.push_back( temp );
+          } else {
+            PrSeedCandidate& best = kept[ bestOf[k] ];
+            if ( temp.hits().size() > best.hits().size() ||
+                 ( temp.hits().size() == best.hits().size() && !( best.chi2() < temp.chi2() ) ) ) {
+              std::swap( best, temp );
+            }
+          }
+        }
+        position[k] += 4;
+      }
+      ++position[k];
+    }
+  }
+
+  for ( unsigned int k = 0; xProjections.size() > k; ++k ) {
+    if ( noBest != bestOf[k] ) state.trackCandidates.push_back( kept[ bestOf[k] ] );
+  }
+}
+
+
+//=========================================================================
+// Solve parabola using Cramer's rule
+//========================================================================
+void PrSeedingSearch::solveParabola(const PrSeedingHitStore& hitStore, unsigned int hit1, unsigned int hit2, unsigned int hit3,
+                                    float& a, float& b, float& c) const {
+
+  const float zRef = m_geometry.zRef();
+  const float z1 = hitStore.z( hit1 ) - zRef;
+  const float z2 = hitStore.z( hit2 ) - zRef;
+  const float z3 = hitStore.z( hit3 ) - zRef;
+
+  const float x1 = hitStore.x( hit1 );
+  const float x2 = hitStore.x( hit2 );
+  const float x3 = hitStore.x( hit3 );
+
+
+  const float det = (z1*z1)*z2 + z1*(z3*z3) + (z2*z2)*z3 - z2*(z3*z3) - z1*(z2*z2) - z3*(z1*z1);
+
+  if( fabs(det) < 1e-8 ){
+    a = 0.0;
+    b = 0.0;
+    c = 0.0;
+    return;
+  }
+
+  const float det1 = (x1)*z2 + z1*(x3) + (x2)*z3 - z2*(x3) - z1*(x2) - z3*(x1);
+  const float det2 = (z1*z1)*x2 + x1*(z3*z3) + (z2*z2)*x3 - x2*(z3*z3) - x1*(z2*z2) - x3*(z1*z1);
+  const float det3 = (z1*z1)*z2*x3 + z1*(z3*z3)*x2 + (z2*z2)*z3*x1 - z2*(z3*z3)*x1 - z1*(z2*z2)*x3 - z3*(z1*z1)*x2;
+
+  a = det1/det;
+  b = det2/det;
+  c = det3/det;
+
+}
@@ -0,0 +1,338 @@
+#ifndef PRSEEDINGSEARCH_H
+#define PRSEEDINGSEARCH_H 1
+
+// Include files
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tbb/task_arena.h"
+
+#include "PrSeedCandidate.h"
+#include "PrSeedingArena.h"
+#include "PrSeedingBatchFit.h"
+#include "PrSeedingCandidateIndex.h"
+#include "PrSeedingClosestHit.h"
+#include "PrSeedingCurvatureTable.h"
+#include "PrSeedingDoublets.h"
+#include "PrSeedingGeometry.h"
+#include "PrSeedingHitStore.h"
+#include "PrSeedingSimd.h"
+#include "PrSeedingUsedHits.h"
+
+/** @class PrSeedingSearch PrSeedingSearch.h
+ *  Search of the seeds of an event in the hits of a PrSeedingHitStore: the x projections
+ *  from the doublets of the first and last zones, then their stereo hits, in each half.
+ *  This is the core of PrSeedingXLayers, without Gaudi, so that it can run in the tests.
+ *
+ *  The search only reads its settings, the geometry table and the curvature table, which
+ *  are set between the events, and the hits, which are given as const. All the state of an
+ *  event is in its EventContext, so that concurrent events each search in their own context
+ *  with the same PrSeedingSearch. The Monitor, nullptr in production, gets the debug output,
+ *  the histograms and the timing of the steps of an event.
+ *
+ *  The lengths are in mm and the momenta in MeV, the units of Gaudi.
+ */
+class PrSeedingSearch {
+public:
+  /// Settings of the search, see the properties of PrSeedingXLayers
+  struct Config {
+    Config()
+      : maxChi2InTrack( 5.5 ), tolXInf( 0.5 ), tolXSup( 8.0 ), minXPlanes( 5 ), maxChi2PerDoF( 4.0 ),
+        xOnly( false ), maxParabolaSeedHits( 4 ), maxXFitRemovals( 3 ), maxXCandidatesPerFirstHit( 0 ),
+        tolTyOffset( 0.002 ), tolTySlope( 0.015 ), maxIpAtZero( 5000. ), xBucketWidth( 4.0 ),
+        useCurvatureTable( false ), curvaturePerQOverP( 0.01 ), curvatureSpread( 0.5 ), curvatureTolerance( 1.0 ),
+        latencyTarget( 0. ), latencyScale( 50. ), concurrentHalves( false ), threadsPerHalf( 1 ),
+        parallelAllCases( false ) {}
+
+    float        maxChi2InTrack;
+    float        tolXInf;
+    float        tolXSup;
+    unsigned int minXPlanes;
+    float        maxChi2PerDoF;
+    bool         xOnly;
+    unsigned int maxParabolaSeedHits;
+    unsigned int maxXFitRemovals;
+    unsigned int maxXCandidatesPerFirstHit;
+    float        tolTyOffset;
+    float        tolTySlope;
+    float        maxIpAtZero;
+    float        xBucketWidth;
+    bool         useCurvatureTable;
+    float        curvaturePerQOverP;
+    float        curvatureSpread;
+    float        curvatureTolerance;
+    float        latencyTarget;
+    float        latencyScale;
+    bool         concurrentHalves;
+    unsigned int threadsPerHalf;
+    bool         parallelAllCases;
+  };
+
+  /// Steps of the search of a half, timed by the Monitor
+  enum Step { XProjections = 0, Stereo };
+
+  /** @class Monitor
+   *  Debug output, histograms and timing of the search of an event. The halves of an event with
+   *  a monitor are searched one after the other; their chunks only if serial() is true.
+   */
+  class Monitor {
+  public:
+    virtual ~Monitor() {}
+
+    /// Debug messages wanted, only then they are formatted
+    virtual bool verbose() const = 0;
+    virtual void debug( const std::string& text ) const = 0;
+    virtual void info( const std::string& text ) const = 0;
+
+    /// Hit of the particle which is studied
+    virtual bool matchKey( const PrHit* hit ) const = 0;
+
+    virtual void histogram( float value, const char* id, const char* title, float low, float high, unsigned int bins ) const = 0;
+
+    virtual void startStep( Step step ) const = 0;
+    virtual void stopStep( Step step ) const = 0;
+
+    /// No concurrent tasks, as the message streams and histograms are shared
+    virtual bool serial() const = 0;
+  };
+
+  /** @class SearchState
+   *  State of the search in one half of the detector, or in a chunk of the first hits of a half.
+   *  A half only reads and sets the used flags of its own hits, through its view of the ones of the event,
+   *  so that the two halves can be searched concurrently.
+   */
+  struct SearchState {
+    SearchState() : nMallocs( 0 ), nRemovals( 0 ), nBelowMinHits( 0 ), nRemovalBudgetExhausted( 0 ), nBeamPruned( 0 ) {}
+
+    /// Forget the previous event
+    void reset() {
+      trackCandidates.clear();
+      xCandidates.clear();
+      arena.reset();
+      nMallocs                = 0;
+      nRemovals               = 0;
+      nBelowMinHits           = 0;
+      nRemovalBudgetExhausted = 0;
+      nBeamPruned             = 0;
+    }
+
+    /// Copy the candidates at the end of to, with their hits in the arena of this state
+    void appendCopies( const PrSeedCandidates& from, PrSeedCandidates& to ) {
+      const PrHitIndices::allocator_type alloc( &arena );
+      for ( PrSeedCandidates::const_iterator itT = from.begin(); from.end() != itT; ++itT ) {
+        to.push_back( PrSeedCandidate( (*itT).zone(), (*itT).zRef(), alloc ) );
+        to.back() = *itT;  // keeps the allocator of the copy
+      }
+    }
+
+    /// Add the counts of other, e.g. a chunk of this half, to the ones of this state
+    void addCounts( const SearchState& other ) {
+      nMallocs                += other.arena.nMallocs() + other.nMallocs;
+      nRemovals               += other.nRemovals;
+      nBelowMinHits           += other.nBelowMinHits;
+      nRemovalBudgetExhausted += other.nRemovalBudgetExhausted;
+      nBeamPruned             += other.nBeamPruned;
+    }
+
+    PrSeedingArena          arena;           ///< scratch memory of the event, reset in start()
+    PrSeedingBatchFit       batchFit;
+    PrSeedingUsedHits       usedHits;        ///< view of the used flags of the event
+    PrSeedingCandidateIndex candidateIndex;  ///< hits of xCandidates, for the clone removal
+    PrSeedCandidates        trackCandidates;
+    PrSeedCandidates        xCandidates;
+    PrSeedCandidates        sortScratch;
+
+    unsigned int            nMallocs;        ///< mallocs of the arenas of the chunks and halves added
+
+    //== Outcome of removeOutliers in the event
+    unsigned int            nRemovals;
+    unsigned int            nBelowMinHits;
+    unsigned int            nRemovalBudgetExhausted;
+    unsigned int            nBeamPruned;     ///< x candidates not fitted for MaxXCandidatesPerFirstHit
+  };
+
+  /** @class EventContext
+   *  State of the search of an event: the used flags of its hits, the scratch memory of the
+   *  halves and of their chunks, and the task arena of the chunks. A context is used by one
+   *  event at a time and keeps its memory for the next one.
+   */
+  struct EventContext {
+    /// Context for the settings of the search, which must not change while it is in use
+    explicit EventContext( const PrSeedingSearch& search );
+
+    /// Forget the previous event, for nHits hits none of which is used
+    void start( unsigned int nHits ) {
+      halves[0].reset();
+      halves[1].reset();
+      usedHits.reset( nHits );
+      tier = 0;
+    }
+
+    PrSeedingUsedHits              usedHits;    ///< used flags of the hits of the event
+    SearchState                    halves[2];   ///< upper (0) and lower (1) half; the counts of the event in 0
+    std::vector<std::unique_ptr<SearchState> > chunks[2]; ///< chunks of the tasks of each half
+    tbb::task_arena                taskArena;   ///< ThreadsPerHalf threads of the tasks of the halves
+    unsigned int                   tier;        ///< PrSeedingTier of the event
+  };
+
+  //== Binning of the curvature table: tx over the acceptance of the T stations, x0 over [-MaxIpAtZero, MaxIpAtZero]
+  enum { curvatureTableTxBins = 40, curvatureTableX0Bins = 100 };
+  static constexpr float curvatureTableTxMax = 0.8f;
+
+  PrSeedingSearch() : m_findClosestHit( nullptr ), m_closestHitLanes( 1 ), m_simdLevel( PrSeedingSimd::Scalar ) {}
+
+  /// Settings, and instruction set of the vector kernels, which must be supported by the CPU
+  void configure( const Config& config, PrSeedingSimd::Level level );
+
+  const Config& config() const { return m_config; }
+  PrSeedingSimd::Level simdLevel() const { return m_simdLevel; }
+
+  /// Zone geometry, filled by the owner when the detector geometry changes
+  PrSeedingGeometry&       geometry()       { return m_geometry; }
+  const PrSeedingGeometry& geometry() const { return m_geometry; }
+
+  const PrSeedingCurvatureTable& curvatureTable() const { return m_curvatureTable; }
+
+  /** @brief Rebuild the curvature table, when the field changes. Built also when UseCurvatureTable
+   *         is off, so that it can be switched on at any time.
+   *  @param qOverP Gives the q/p estimated for the straight line ( tx, x0 ) through two hits
+   */
+  template <typename QOverP>
+  void buildCurvatureTable( QOverP qOverP ) {
+    const Config& config = m_config;
+    m_curvatureTable.build( curvatureTableTxBins, curvatureTableTxMax, curvatureTableX0Bins, config.maxIpAtZero,
+                            [&config, &qOverP]( float tx, float x0, float& curvature, float& spread ) {
+                              curvature = std::fabs( config.curvaturePerQOverP * qOverP( tx, x0 ) );
+                              spread    = config.curvatureSpread * curvature;
+                            } );
+  }
+
+  /** @brief Search the seeds of an event, whose context was started and whose hits already used are set
+   *  @param hits The hits of the event
+   *  @param event The context of the event, which gets the tracks of each half and the counts
+   *  @param monitor The debug output and timing of the event, nullptr if none
+   */
+  void search( const PrSeedingHitStore& hits, EventContext& event, const Monitor* monitor ) const;
+
+  /** @brief Collect hits in the stereo-layers for the x projections [kBegin, kEnd).
+   *  @param hits The hits of the event
+   *  @param part lower (1) or upper (0) half
+   *  @param xCandidates The x projections of the half
+   *  @param kBegin First x projection
+   *  @param kEnd End of the x projections
+   *  @param state State of the search, which gets the tracks
+   */
+  void addStereoToProjections( const PrSeedingHitStore& hits, unsigned int part, const PrSeedCandidates& xCandidates,
+                               unsigned int kBegin, unsigned int kEnd, SearchState& state ) const;
+
+private:
+  /** @brief Fit the track with a parabola, see PrSeedingBatchFit::fitTrack
+   *  @param hits The hits of the event
+   *  @param track The track to fit
+   *  @param moments The moments of the hits of the track
+   *  @param worst Set to the position of the hit with the largest chi2
+   *  @return bool Success of the fit
+   */
+  bool fitTrack( const PrSeedingHitStore& hits, PrSeedCandidate& track, const PrSeedingBatchFit::Moments& moments,
+                 unsigned int& worst ) const;
+
+  /** @brief Remove the hit which gives the largest contribution to the chi2 and refit
+   *  @param hits The hits of the event
+   *  @param track The track to fit
+   *  @param moments The moments of the hits of the track, downdated for the removed hit
+   *  @param worst Position of this hit, as given by the last fit, set to the one of the refit
+   *  @return bool Success of the fit
+   */
+  bool removeWorstAndRefit( const PrSeedingHitStore& hits, PrSeedCandidate& track,
+                            PrSeedingBatchFit::Moments& moments, unsigned int& worst ) const;
+
+  /** @brief Remove the worst hit and refit until the fit succeeds, at most maxRemovals times
+   *         and never below minHits hits. The outcome is counted for the event.
+   *  @param hits The hits of the event
+   *  @param track The track, whose last fit failed
+   *  @param worst Position of the hit with the largest chi2 in the last fit
+   *  @param minHits Minimum number of hits of the track
+   *  @param maxRemovals Maximum number of hits removed
+   *  @param state The search of the track, where the outcome is counted
+   *  @return bool Success of the fit
+   */
+  bool removeOutliers( const PrSeedingHitStore& hits, PrSeedCandidate& track, unsigned int worst,
+                       unsigned int minHits, unsigned int maxRemovals, SearchState& state ) const;
+
+  /** @brief Set the chi2 of the track
+   *  @param hits The hits of the event
+   *  @param track The track to set the chi2 of
+   */
+  void setChi2( const PrSeedingHitStore& hits, PrSeedCandidate& track ) const;
+
+  /** @brief Find the x projections, then add the stereo hits, in one half
+   *  @param hits The hits of the event
+   *  @param event The event
+   *  @param part lower (1) or upper (0) half
+   *  @param monitor The debug output of the event, nullptr if none
+   */
+  void searchHalf( const PrSeedingHitStore& hits, EventContext& event, unsigned int part, const Monitor* monitor ) const;
+
+  /** @brief Collect hits in the x-layers using a parabolic search window.
+   *  @param hits The hits of the event
+   *  @param event The event, with the state of the search in this half
+   *  @param part lower (1) or upper (0) half
+   *  @param monitor The debug output of the event, nullptr if none
+   */
+  void findXProjections2( const PrSeedingHitStore& hits, EventContext& event, unsigned int part,
+                          const Monitor* monitor ) const;
+
+  /** @brief Collect hits in the x-layers from the first hits of the groups [gBegin, gEnd) of doublets of a case.
+   *  @param hits The hits of the event
+   *  @param tierOfEvent The PrSeedingTier of the event
+   *  @param part lower (1) or upper (0) half
+   *  @param iCase The case of the first and last zones
+   *  @param doublets The doublets of the case
+   *  @param gBegin First group
+   *  @param gEnd End of the groups
+   *  @param state State of the search, which gets the candidates
+   *  @param monitor The debug output of the event, nullptr if none
+   */
+  void findXProjectionsInGroups( const PrSeedingHitStore& hits, unsigned int tierOfEvent, unsigned int part, unsigned int iCase,
+                                 const PrSeedingDoublets& doublets, unsigned int gBegin, unsigned int gEnd,
+                                 SearchState& state, const Monitor* monitor ) const;
+
+  /** @brief Collect hits in the stereo-layers.
+   *  @param hits The hits of the event
+   *  @param event The event, with the state of the search in this half
+   *  @param part lower (1) or upper (0) half
+   *  @param monitor The debug output of the event, nullptr if none
+   */
+  void addStereo2( const PrSeedingHitStore& hits, EventContext& event, unsigned int part, const Monitor* monitor ) const;
+
+  /** @brief Run f( chunk, begin, end ) on the chunks of [0, n) of a half, as tasks
+   *  @param event The event, with the chunks and their task arena
+   *  @param part lower (1) or upper (0) half
+   *  @param n Number of items
+   *  @param f Work on the items [begin, end), with the state of the chunk
+   */
+  template <typename F>
+  void runChunks( EventContext& event, unsigned int part, unsigned int n, const F& f ) const;
+
+  /** @brief Internal method to construct parabolic parametrisation out of three hits, using Cramer's rule.
+   *  @param hits The hits of the event
+   *  @param hit1 First hit (index in the hit store)
+   *  @param hit2 Second hit (index in the hit store)
+   *  @param hit3 Third hit (index in the hit store)
+   *  @param a quadratic coefficient
+   *  @param b linear coefficient
+   *  @param c offset
+   */
+  void solveParabola( const PrSeedingHitStore& hits, unsigned int hit1, unsigned int hit2, unsigned int hit3,
+                      float& a, float& b, float& c ) const;
+
+  Config                    m_config;
+  PrSeedingGeometry         m_geometry;          ///< zone geometry, filled by the owner
+  PrSeedingCurvatureTable   m_curvatureTable;    ///< filled in buildCurvatureTable()
+  PrSeedingClosestHit::Find m_findClosestHit;    ///< nullptr for the scalar instruction set
+  unsigned int              m_closestHitLanes;
+  PrSeedingSimd::Level      m_simdLevel;         ///< of the batch fits of the contexts
+};
+#endif // PRSEEDINGSEARCH_H
@@ -0,0 +1,93 @@
+#ifndef PRSEEDINGSIMD_H
+#define PRSEEDINGSIMD_H 1
+
+// Include files
+#include <string>
+
+/** Instruction sets of the vector kernels of the seeding (PrSeedingBatchFit,
+ *  PrSeedingClosestHit). Each kernel is compiled for all of them in the same library,
+ *  with the GCC target attribute, and the best one supported by the CPU is taken at
+ *  initialize().
+ *
+ *  FMA is not contracted in any of them, nor in the scalar fit (PRSEEDING_NO_CONTRACT), also
+ *  when the library is built with -mfma: all instruction sets give exactly the same tracks.
+ */
+namespace PrSeedingSimd {
+
+  enum Level { Scalar = 0, SSE42, AVX2, AVX512 };
+
+  /// Lanes of a float vector
+  inline unsigned int lanes( Level level ) {
+    switch ( level ) {
+    case SSE42:  return 4;
+    case AVX2:   return 8;
+    case AVX512: return 16;
+    default:     return 1;
+    }
+  }
+
+  inline const char* name( Level level ) {
+    switch ( level ) {
+    case SSE42:  return "sse4.2";
+    case AVX2:   return "avx2";
+    case AVX512: return "avx512";
+    default:     return "scalar";
+    }
+  }
+
+  /// Level with this name, false if there is none
+  inline bool fromName( const std::string& str, Level& level ) {
+    for ( int l = Scalar; AVX512 >= l; ++l ) {
+      if ( name( Level( l ) ) == str ) {
+        level = Level( l );
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Can this CPU run the kernels of this level?
+  inline bool supported( Level level ) {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    __builtin_cpu_init();
+    switch ( level ) {
+    case SSE42:  return __builtin_cpu_supports( "sse4.2" );
+    case AVX2:   return __builtin_cpu_supports( "avx2" );
+    case AVX512: return __builtin_cpu_supports( "avx512f" );
+    default:     return true;
+    }
+#else
+    return Scalar == level;
+#endif
+  }
+
+  /// Best level supported by this CPU
+  inline Level best() {
+    for ( int l = AVX512; Scalar < l; --l ) {
+      if ( supported( Level( l ) ) ) return Level( l );
+    }
+    return Scalar;
+  }
+
+  /// Float and int vectors of W lanes
+  template <unsigned int W>
+  struct Lanes {
+    typedef float F __attribute__(( vector_size( 4 * W ) ));
+    typedef int   I __attribute__(( vector_size( 4 * W ) ));
+  };
+}
+
+/// The kernels are templates inlined into one function per instruction set, which gives their target
+#define PRSEEDING_KERNEL inline __attribute__(( always_inline ))
+
+/// Function compiled for an instruction set, AVX-512 implies FMA which must not be contracted
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define PRSEEDING_TARGET( isa ) __attribute__(( target( isa ), optimize( "fp-contract=off" ) ))
+#else
+#define PRSEEDING_TARGET( isa )
+#endif
+
+/// Scalar function which must give the results of the kernels, even in a build with FMA
+#define PRSEEDING_NO_CONTRACT __attribute__(( optimize( "fp-contract=off" ) ))
+
+#endif // PRSEEDINGSIMD_H
@@ -0,0 +1,167 @@
+#ifndef PRSEEDINGSORT_H
+#define PRSEEDINGSORT_H 1
+
+// Include files
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+#include "PrSeedingArena.h"
+
+/** Sorting helpers of the seeding. Unlike std::stable_sort, they never ask the heap for a
+ *  temporary buffer: small ranges are insertion sorted, larger ones are merge sorted, or radix
+ *  sorted when the order is given by a float key, with buffers from the event arena.
+ */
+namespace PrSeedingSort {
+
+  /// Ranges up to this size are insertion sorted
+  const std::size_t insertionSortLimit = 16;
+
+  template <typename It, typename Compare>
+  void insertionSort( It first, It last, Compare comp ) {
+    if ( first == last ) return;
+    for ( It it = first + 1; last != it; ++it ) {
+      typename std::iterator_traits<It>::value_type tmp = std::move( *it );
+      It hole = it;
+      for ( ; first != hole && comp( tmp, *( hole - 1 ) ); --hole ) *hole = std::move( *( hole - 1 ) );
+      *hole = std::move( tmp );
+    }
+  }
+
+  /// Bottom-up merge sort of trivially copyable elements, with the buffer taken from the arena and given back
+  template <typename T, typename Compare>
+  void mergeSort( T* data, std::size_t n, Compare comp, PrSeedingArena& arena ) {
+    for ( std::size_t start = 0; n > start; start += insertionSortLimit ) {
+      insertionSort( data + start, data + std::min( n, start + insertionSortLimit ), comp );
+    }
+    T* buffer = static_cast<T*>( arena.allocate( n * sizeof( T ), alignof( T ) ) );
+    T* from = data;
+    T* to   = buffer;
+    for ( std::size_t width = insertionSortLimit; n > width; width *= 2 ) {
+      for ( std::size_t start = 0; n > start; start += 2 * width ) {
+        const std::size_t mid = std::min( n, start + width );
+        const std::size_t end = std::min( n, start + 2 * width );
+        std::size_t i = start, j = mid, k = start;
+        while ( i < mid && j < end ) to[k++] = comp( from[j], from[i] ) ? from[j++] : from[i++];
+        while ( i < mid ) to[k++] = from[i++];
+        while ( j < end ) to[k++] = from[j++];
+      }
+      std::swap( from, to );
+    }
+    if ( from != data ) std::copy( from, from + n, data );
+    arena.deallocate( buffer, n * sizeof( T ) );
+  }
+
+  template <typename It, typename Compare>
+  void stableSort( It first, It last, Compare comp, PrSeedingArena& arena, std::true_type /* trivially copyable */ ) {
+    const std::size_t n = last - first;
+    if ( n <= insertionSortLimit ) {
+      insertionSort( first, last, comp );
+    } else {
+      mergeSort( &*first, n, comp, arena );
+    }
+  }
+
+  template <typename It, typename Compare>
+  void stableSort( It first, It last, Compare comp, PrSeedingArena&, std::false_type ) {
+    insertionSort( first, last, comp );
+  }
+
+  /// Stable sort of a contiguous range, as std::stable_sort but without heap allocation
+  template <typename It, typename Compare>
+  void stableSort( It first, It last, Compare comp, PrSeedingArena& arena ) {
+    typedef typename std::iterator_traits<It>::value_type T;
+    stableSort( first, last, comp, arena, typename std::is_trivially_copyable<T>::type() );
+  }
+
+  /// Ranges up to this size are sorted by comparison in radixSortByKey. The merge sort ties with the
+  /// radix sort at 512 elements, which only wins from about 2000 (bench_PrSeedingSort)
+  const std::size_t radixSortLimit = 2000;
+
+  /// Unsigned integer with the same order as the float, -0 and +0 being equal
+  inline uint32_t orderedKey( float value ) {
+    value += 0.f;
+    uint32_t bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return ( bits & 0x80000000u ) ? ~bits : ( bits | 0x80000000u );
+  }
+
+  /** Stable sort of a contiguous range of trivially copyable elements by a float key, in the
+   *  same order as stableSort with key( lhs ) < key( rhs ). The key is computed once per element
+   *  and packed with the position of the element in 64 bits, these are sorted by LSD radix on
+   *  the key, 8 bits per pass, then the elements are put in their place. The passes where all
+   *  keys have the same digit are skipped. The buffers are taken from the arena and given back.
+   *  Ranges up to limit elements are sorted by comparison instead.
+   */
+  template <typename It, typename Key>
+  void radixSortByKey( It first, It last, Key key, PrSeedingArena& arena, std::size_t limit = radixSortLimit ) {
+    typedef typename std::iterator_traits<It>::value_type T;
+    static_assert( std::is_trivially_copyable<T>::value, "radixSortByKey moves the elements with memcpy" );
+    const std::size_t n = last - first;
+    if ( n <= limit ) {
+      stableSort( first, last, [&key]( const T& lhs, const T& rhs ) -> bool { return key( lhs ) < key( rhs ); }, arena );
+      return;
+    }
+
+    uint64_t* keys = static_cast<uint64_t*>( arena.allocate( 2 * n * sizeof( uint64_t ), alignof( uint64_t ) ) );
+    uint64_t* from = keys;
+    uint64_t* to   = keys + n;
+    T* data = &*first;
+    uint32_t count[4][256] = {};
+    for ( std::size_t i = 0; n > i; ++i ) {
+      const uint32_t k = orderedKey( key( data[i] ) );
+      from[i] = ( uint64_t( k ) << 32 ) | i;
+      ++count[0][k & 0xff];
+      ++count[1][( k >> 8 ) & 0xff];
+      ++count[2][( k >> 16 ) & 0xff];
+      ++count[3][k >> 24];
+    }
+
+    for ( unsigned int d = 0; 4 > d; ++d ) {
+      const unsigned int shift = 32 + 8 * d;
+      if ( n == count[d][( from[0] >> shift ) & 0xff] ) continue;
+      uint32_t offset = 0;
+      for ( unsigned int b = 0; 256 > b; ++b ) {
+        const uint32_t c = count[d][b];
+        count[d][b] = offset;
+        offset += c;
+      }
+      for ( std::size_t i = 0; n > i; ++i ) to[count[d][( from[i] >> shift ) & 0xff]++] = from[i];
+      std::swap( from, to );
+    }
+
+    T* sorted = static_cast<T*>( arena.allocate( n * sizeof( T ), alignof( T ) ) );
+    for ( std::size_t i = 0; n > i; ++i ) std::memcpy( sorted + i, data + uint32_t( from[i] ), sizeof( T ) );
+    std::memcpy( data, sorted, n * sizeof( T ) );
+
+    // -- Last allocated, first given back
+    arena.deallocate( sorted, n * sizeof( T ) );
+    arena.deallocate( keys, 2 * n * sizeof( uint64_t ) );
+  }
+
+  /** Stable sort by decreasing value of a small unsigned key, as needed to order candidates
+   *  by number of hits. The elements are moved to scratch and swapped back.
+   */
+  template <typename T, typename Key>
+  void stableSortByDecreasingKey( std::vector<T>& items, std::vector<T>& scratch, Key key ) {
+    if ( items.size() < 2 ) return;
+    unsigned int minKey = key( items.front() );
+    unsigned int maxKey = minKey;
+    for ( typename std::vector<T>::const_iterator it = items.begin(); items.end() != it; ++it ) {
+      minKey = std::min( minKey, key( *it ) );
+      maxKey = std::max( maxKey, key( *it ) );
+    }
+    scratch.clear();
+    for ( unsigned int k = maxKey + 1; minKey < k; --k ) {
+      for ( typename std::vector<T>::iterator it = items.begin(); items.end() != it; ++it ) {
+        if ( key( *it ) == k - 1 ) scratch.push_back( std::move( *it ) );
+      }
+    }
+    items.swap( scratch );
+    scratch.clear();
+  }
+}
+#endif // PRSEEDINGSORT_H
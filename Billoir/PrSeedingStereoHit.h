@@ -0,0 +1,29 @@
+#ifndef PRSEEDINGSTEREOHIT_H
+#define PRSEEDINGSTEREOHIT_H 1
+
+// Include files
+#include <vector>
+
+#include "PrSeedingArena.h"
+
+/** @class PrSeedingStereoHit PrSeedingStereoHit.h
+ *  Stereo hit compatible with one x projection: the coordinate ( x - xPred ) / dxDy / z,
+ *  i.e. the y slope of the hit seen from the origin, with the index of the hit in the
+ *  PrSeedingHitStore and its plane code. Kept in a scratch array per x projection,
+ *  instead of in the coord() of the shared PrHits.
+ */
+struct PrSeedingStereoHit {
+  PrSeedingStereoHit( float c, unsigned int h, unsigned int p ) : coord( c ), hit( h ), planeCode( p ) {}
+
+  float        coord;
+  unsigned int hit;
+  unsigned int planeCode;
+
+  struct LowerByCoord {
+    bool operator() ( const PrSeedingStereoHit& lhs, const PrSeedingStereoHit& rhs ) const { return lhs.coord < rhs.coord; }
+  };
+};
+
+typedef std::vector<PrSeedingStereoHit, PrSeedingArena::Allocator<PrSeedingStereoHit> > PrSeedingStereoHits;
+
+#endif // PRSEEDINGSTEREOHIT_H
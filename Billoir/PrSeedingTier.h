@@ -0,0 +1,56 @@
+#ifndef PRSEEDINGTIER_H
+#define PRSEEDINGTIER_H 1
+
+// Include files
+#include <algorithm>
+
+/** @class PrSeedingTier PrSeedingTier.h
+ *  Configuration of the x projection search for an event, chosen from its number of hits
+ *  when a latency target is set. Tier 0 is the nominal configuration; each of the next tiers
+ *  is cheaper and loses some efficiency:
+ *  - 1: TolXSup halved, at most 2 hits to seed the parabolas of a doublet
+ *  - 2: as 1, and only the first case (first and last zones in T1 and T3)
+ *
+ *  The time of the nominal configuration is taken to grow as the cube of the number of hits,
+ *  from its value for 10000 hits; the cost of the tiers is relative to it. Both are heuristics,
+ *  not measurements: the cube follows the combinatorics of the x search in busy events, and
+ *  LatencyScale and the costs have to be calibrated with TimingMeasurement on the target machine.
+ */
+class PrSeedingTier {
+public:
+  enum { nTiers = 3 };
+
+  /** @brief Cheapest tier needed to keep the estimated time within the target
+   *  @param nHits Number of hits of the event
+   *  @param latencyScale Time of the nominal configuration for 10000 hits
+   *  @param latencyTarget Target time of an event, the last tier is taken if none reaches it
+   *  @return unsigned int The tier
+   */
+  static unsigned int choose( unsigned int nHits, float latencyScale, float latencyTarget ) {
+    const float scale   = 1.e-4f * nHits;
+    const float nominal = latencyScale * scale * scale * scale;
+    for ( unsigned int tier = 0; nTiers - 1 > tier; ++tier ) {
+      if ( get( tier ).cost * nominal <= latencyTarget ) return tier;
+    }
+    return nTiers - 1;
+  }
+
+  static const PrSeedingTier& get( unsigned int tier ) {
+    static const PrSeedingTier tiers[nTiers] = { { 1.0f, 1.00f, ~0u, 3 },
+                                                 { 0.5f, 0.75f,  2u, 3 },
+                                                 { 0.5f, 0.50f,  2u, 1 } };
+    return tiers[tier];
+  }
+
+  /// Tolerance of the window of the seed hits of the parabolas, for the nominal one
+  float tolXSup( float nominal ) const { return tolXSupScale * nominal; }
+
+  /// Number of hits to seed the parabolas, for the nominal one
+  unsigned int maxParabolaSeedHits( unsigned int nominal ) const { return std::min( nominal, maxSeedHits ); }
+
+  float        tolXSupScale;  ///< Factor of TolXSup
+  float        cost;          ///< Time relative to the nominal configuration
+  unsigned int maxSeedHits;   ///< Upper limit of MaxParabolaSeedHits
+  unsigned int nCases;        ///< Number of cases searched
+};
+#endif // PRSEEDINGTIER_H
@@ -0,0 +1,74 @@
+#ifndef PRSEEDINGUSEDHITS_H
+#define PRSEEDINGUSEDHITS_H 1
+
+// Include files
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+/** @class PrSeedingUsedHits PrSeedingUsedHits.h
+ *  "Used" flags of the hits of the PrSeedingHitStore, one bit per hit index, owned by the
+ *  algorithm instead of being stored in the shared PrHits. Clearing is a memset.
+ *
+ *  view() gives a copy-on-write view for a concurrent task: it reads the flags of its
+ *  parent until its first setUsed(), when it takes its own copy. The parent must not be
+ *  modified while views of it are in use; merge() folds the flags of a view back.
+ */
+class PrSeedingUsedHits {
+public:
+  PrSeedingUsedHits() : m_words( nullptr ), m_nWords( 0 ) {}
+
+  PrSeedingUsedHits( const PrSeedingUsedHits& other )
+    : m_own( other.m_own ), m_words( other.ownsWords() ? m_own.data() : other.m_words ), m_nWords( other.m_nWords ) {}
+
+  PrSeedingUsedHits& operator=( const PrSeedingUsedHits& other ) {
+    if ( this == &other ) return *this;
+    m_own    = other.m_own;
+    m_words  = other.ownsWords() ? m_own.data() : other.m_words;
+    m_nWords = other.m_nWords;
+    return *this;
+  }
+
+  /// Clear all flags, for nHits hits
+  void reset( unsigned int nHits ) {
+    m_nWords = ( nHits + 63 ) / 64;
+    m_own.resize( m_nWords );
+    if ( 0 != m_nWords ) std::memset( m_own.data(), 0, m_nWords * sizeof( uint64_t ) );
+    m_words = m_own.data();
+  }
+
+  bool isUsed( unsigned int hit ) const { return 0 != ( ( m_words[hit >> 6] >> ( hit & 63 ) ) & 1 ); }
+
+  void setUsed( unsigned int hit ) {
+    if ( !ownsWords() ) takeCopy();
+    m_own[hit >> 6] |= uint64_t( 1 ) << ( hit & 63 );
+  }
+
+  /// Copy-on-write view of these flags
+  PrSeedingUsedHits view() const {
+    PrSeedingUsedHits v;
+    v.m_words  = m_words;
+    v.m_nWords = m_nWords;
+    return v;
+  }
+
+  /// Add the flags set in other, e.g. a view given to a concurrent task
+  void merge( const PrSeedingUsedHits& other ) {
+    if ( other.m_words == m_words ) return;
+    if ( !ownsWords() ) takeCopy();
+    for ( unsigned int k = 0; m_nWords > k; ++k ) m_own[k] |= other.m_words[k];
+  }
+
+private:
+  bool ownsWords() const { return m_words == m_own.data() && !m_own.empty(); }
+
+  void takeCopy() {
+    m_own.assign( m_words, m_words + m_nWords );
+    m_words = m_own.data();
+  }
+
+  std::vector<uint64_t> m_own;
+  const uint64_t*       m_words;
+  unsigned int          m_nWords;
+};
+#endif // PRSEEDINGUSEDHITS_H
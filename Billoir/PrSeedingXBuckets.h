@@ -0,0 +1,66 @@
+#ifndef PRSEEDINGXBUCKETS_H
+#define PRSEEDINGXBUCKETS_H 1
+
+// Include files
+#include <vector>
+
+/** @class PrSeedingXBuckets PrSeedingXBuckets.h
+ *  Uniform grid in x over the hits of one zone, sorted by x, to find the start of a
+ *  search window with one multiply and one load instead of a binary search.
+ *
+ *  The hits are given by position 0..n-1 and an accessor getX( i ), so that the same
+ *  index works on a PrHits range ( [&hits]( unsigned int i ) { return hits[i]->x(); } )
+ *  and on a structure-of-arrays ( [xs]( unsigned int i ) { return xs[i]; } ).
+ *
+ *  The bin of a hit is a monotonic function of x: every hit before the start of the bin
+ *  of x has a smaller x, so lowerBound() gives exactly the result of std::lower_bound.
+ */
+class PrSeedingXBuckets {
+public:
+  /// Bins above this number are merged into the last one
+  enum { maxBins = 1 << 16 };
+
+  PrSeedingXBuckets() : m_xLo( 0. ), m_invWidth( 0. ), m_lastBin( 0 ) {}
+
+  template <typename GetX>
+  void build( unsigned int n, GetX getX, float width ) {
+    m_start.clear();
+    m_lastBin = 0;
+    if ( 0 == n ) {
+      m_start.push_back( 0 );
+      return;
+    }
+    m_xLo      = getX( 0 );
+    m_invWidth = 1.f / width;
+    const float range = ( getX( n - 1 ) - m_xLo ) * m_invWidth;
+    m_lastBin = range < maxBins - 1 ? static_cast<unsigned int>( range ) : maxBins - 1;
+
+    unsigned int i = 0;
+    for ( unsigned int b = 0; m_lastBin >= b; ++b ) {
+      while ( n != i && bin( getX( i ) ) < b ) ++i;
+      m_start.push_back( i );
+    }
+  }
+
+  /// Position of the first hit with x >= xMin, n if there is none
+  template <typename GetX>
+  unsigned int lowerBound( float xMin, unsigned int n, GetX getX ) const {
+    unsigned int i = m_start[bin( xMin )];
+    while ( n != i && getX( i ) < xMin ) ++i;
+    return i;
+  }
+
+private:
+  unsigned int bin( float x ) const {
+    const float f = ( x - m_xLo ) * m_invWidth;
+    if ( !( f > 0.f ) ) return 0;
+    if ( f >= m_lastBin ) return m_lastBin;
+    return static_cast<unsigned int>( f );
+  }
+
+  float                     m_xLo;
+  float                     m_invWidth;
+  unsigned int              m_lastBin;
+  std::vector<unsigned int> m_start;
+};
+#endif // PRSEEDINGXBUCKETS_H
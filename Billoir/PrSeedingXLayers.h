@@ -3,6 +3,8 @@
 #define PRSEEDINGYLAYERS_H 1
 
 // Include files
+#include <mutex>
+
 // from Gaudi
 
 //#define DEBUG_HISTO 
@@ -14,10 +16,15 @@
 #include "GaudiAlg/GaudiAlgorithm.h"
 #endif
 #include "GaudiAlg/ISequencerTimerTool.h"
+#include "Kernel/ILHCbMagnetSvc.h"
 
 #include "PrKernel/IPrDebugTool.h"
 #include "PrKernel/PrHitManager.h"
 #include "PrSeedTrack.h"
+#include "PrSeedCandidate.h"
+#include "PrSeedingHitStore.h"
+#include "PrSeedingPool.h"
+#include "PrSeedingSearch.h"
 #include "PrGeometryTool.h"
 #include "TfKernel/RecoFuncs.h"
 
@@ -37,14 +44,42 @@
  * - MinXPlanes: Minimum number of x-planes a track needs to have
  * - MaxChi2PerDoF: Maximum Chi2/nDoF a track can have.
  * - MaxParabolaSeedHits: Maximum number of hits which are use to construct a parabolic search window.
+ * - MaxXFitRemovals: Maximum number of hits removed from an x candidate whose fit fails, before it is rejected.
+ * - MaxXCandidatesPerFirstHit: Maximum number of x candidates fitted per hit of the first zone, the ones with most hits closest to their parabola (0: no limit).
  * - TolTyOffset: Tolerance for the offset in y for adding stereo hits.
  * - TolTySlope: Tolerance for the slope in y for adding stereo hits.
  * - MaxIpAtZero: Maximum impact parameter of the track when doing a straight extrapolation to zero. Acts as a momentum cut.
+ * - XBucketWidth: Bin width of the x grid used to find the start of the search windows in a zone.
+ * - UseCurvatureTable: Narrow the window of the seed hits of the parabolas to the curvature expected for the momentum.
+ * - CurvaturePerQOverP: Curvature of the x projection in the T stations per unit of q/p, see below.
+ * - CurvatureSpread: Relative spread of the curvature around the expected one.
+ * - CurvatureTolerance: Tolerance in x added to the window given by the curvature.
+ * - InstructionSet: Instruction set of the vector kernels: scalar, sse4.2, avx2, avx512, or auto for the best one of the CPU.
+ * - LatencyTarget: Target time of an event, in ms. The busy events are searched with a cheaper configuration (tier) to stay within it, see PrSeedingTier (0: always the nominal one).
+ * - LatencyScale: Time of the nominal configuration for an event of 10000 hits, in ms, from which the time of an event is estimated. The estimate grows as the cube of the number of hits: a heuristic, to be checked against the timing of the machine and the sample.
+ * - ConcurrentHalves: Search the upper and lower halves concurrently, as two tasks. Not with TimingMeasurement, debug output or a WantedKey.
+ * - ThreadsPerHalf: Number of threads working on a half: the x search runs in chunks of first hits and the stereo hits are added in chunks of x projections (1: serial). Not with debug output or a WantedKey.
+ * - ParallelAllCases: Also search the second and third cases in chunks. Then a chunk does not skip the hits used by the chunks before it, and the result differs from the serial one.
  * - DebugToolName: Name of the debug tool
  * - WantedKey: Key of the particle which should be studied (for debugging).
  * - TimingMeasurement: Do timing measurement and print table at the end (?).
  * - PrintSettings: Print all values of the properties at the beginning?
  *
+ *  The curvature table gives, for the straight line ( tx, x0 ) through the two hits of a doublet,
+ *  CurvaturePerQOverP times the q/p estimated by PrGeometryTool::qOverP(), which already
+ *  includes the polarity and scale of the field. CurvaturePerQOverP is then the ratio c / ( q/p )
+ *  of the curvature c of x = a + b*dz + c*dz*dz fitted to the true x hits of simulated tracks,
+ *  and CurvatureSpread the relative RMS of c around it: both are to be tuned on simulation,
+ *  the defaults are only of the right order of magnitude (1 mm over 1 m for 10 GeV).
+ *
+ *  The search itself is in PrSeedingSearch, which only reads its settings and tables and the
+ *  hits of an event. Each event takes its hits and the context of their search from a thread safe
+ *  pool, so that the events can be searched concurrently; execute() copies the hits from the
+ *  PrHitManager tool, which holds those of the last decoded event, under a lock. With
+ *  TimingMeasurement, debug output or a WantedKey the events are searched one at a time, as they
+ *  share the timers, the message streams and the hits of the hit manager. Within an event, the
+ *  halves and their chunks run as tasks, see ConcurrentHalves and ThreadsPerHalf.
+ *
  *  @author Olivier Callot
  *  @date   2013-02-14
  *  2014-06-26 : Yasmine Amhis Modification
@@ -65,130 +100,96 @@ public:
   virtual StatusCode execute   ();    ///< Algorithm execution
   virtual StatusCode finalize  ();    ///< Algorithm finalization
 
+  StatusCode updateGeometry();        ///< Rebuild the geometry table of the zones
+  StatusCode updateCurvatureTable();  ///< Rebuild the curvature table for the field
+
  
 
 protected:
 
-  /** @brief Collect hits in the x-layers. Obsolete, just kept for documentation
-   *  @param part lower (1) or upper (0) half
+  /** @class EventData
+   *  Hits of an event and the context of their search, taken from the pool for one event
    */
-  void findXProjections( unsigned int part );
+  struct EventData {
+    explicit EventData( const PrSeedingSearch& search ) : context( search ) {
+      hits.setBucketWidth( search.config().xBucketWidth );
+    }
 
-  /** @brief Collect hits in the stereo-layers. Obsolete, just kept for documentation
-   *  @param part lower (1) or upper (0) half
-   */
-  void addStereo( unsigned int part );
-  
-  /** @brief Fit the track with a parabola
-   *  @param track The track to fit
-   *  @return bool Success of the fit
-   */
-  bool fitTrack( PrSeedTrack& track );
+    PrSeedingHitStore             hits;
+    PrSeedingSearch::EventContext context;
+  };
 
-  /** @brief Remove the hit which gives the largest contribution to the chi2 and refit
-   *  @param track The track to fit
-   *  @return bool Success of the fit
+  /** @class SearchMonitor
+   *  Debug output, histograms and timers of this algorithm, for the search of an event
    */
-  bool removeWorstAndRefit( PrSeedTrack& track );
-  
-  /** @brief Set the chi2 of the track
-   *  @param track The track to set the chi2 of 
+  class SearchMonitor : public PrSeedingSearch::Monitor {
+  public:
+    explicit SearchMonitor( const PrSeedingXLayers& parent ) : m_parent( parent ) {}
+
+    virtual bool verbose() const;
+    virtual void debug( const std::string& text ) const;
+    virtual void info( const std::string& text ) const;
+    virtual bool matchKey( const PrHit* hit ) const;
+    virtual void histogram( float value, const char* id, const char* title, float low, float high, unsigned int bins ) const;
+    virtual void startStep( PrSeedingSearch::Step step ) const;
+    virtual void stopStep( PrSeedingSearch::Step step ) const;
+    virtual bool serial() const;
+
+  private:
+    const PrSeedingXLayers& m_parent;
+  };
+
+  /** @brief Search the seeds of an event
+   *  @param event The hits of the event, already filled, and the context of their search
+   *  @param forward The forward tracks whose hits are not used again, nullptr if none
+   *  @param result The container of the seeds
+   *  @param monitor The debug output and timers, nullptr if none
    */
-  void setChi2( PrSeedTrack& track );
+  void search( EventData& event, const LHCb::Tracks* forward, LHCb::Tracks* result, const SearchMonitor* monitor ) const;
 
   /** @brief Transform the tracks from the internal representation into LHCb::Tracks
-   *  @param tracks The tracks to transform
+   *  @param event The event, with the tracks of its halves
+   *  @param result The container of the LHCb::Tracks
    */
-  void makeLHCbTracks( LHCb::Tracks* result );
+  void makeLHCbTracks( const EventData& event, LHCb::Tracks* result ) const;
 
   /** @brief Print some information of the hit in question
-   *  @param hit The hit whose information should be printed
+   *  @param event The event of the hit
+   *  @param iH The hit whose information should be printed (index in the hit store)
    *  @param title Some additional information to be printed
    */
-  void printHit( const PrHit* hit, std::string title="" );
+  void printHit( const EventData& event, unsigned int iH, std::string title="" ) const;
 
   /** @brief Print some information of the track in question
+   *  @param event The event of the track
    *  @param hit The track whose information should be printed
    */
-  void printTrack( PrSeedTrack& track );
+  void printTrack( const EventData& event, PrSeedCandidate& track ) const;
 
   
-  bool matchKey( const PrHit* hit ) {
+  bool matchKey( const PrHit* hit ) const {
     if ( m_debugTool ) return m_debugTool->matchKey( hit->id(), m_wantedKey );
     return false;
   };
 
-  bool matchKey( const PrSeedTrack& track ) {
+  bool matchKey( const PrSeedingHitStore& hitStore, const PrSeedCandidate& track ) const {
     if ( !m_debugTool ) return false;
-    for ( PrHits::const_iterator itH = track.hits().begin(); track.hits().end() != itH; ++itH ) {
-      if ( m_debugTool->matchKey( (*itH)->id(), m_wantedKey ) ) return true;
+    for ( PrHitIndices::const_iterator itH = track.hits().begin(); track.hits().end() != itH; ++itH ) {
+      if ( m_debugTool->matchKey( hitStore.id( *itH ), m_wantedKey ) ) return true;
     }
     return false;
   };
 
-
-  /** @brief Collect hits in the x-layers using a parabolic search window.
-   *  @param part lower (1) or upper (0) half
-   */
-  void findXProjections2( unsigned int part );
-  
-  /** @brief Collect hits in the stereo-layers.
-   *  @param part lower (1) or upper (0) half
-   */
-  void addStereo2( unsigned int part );
-
-  /** @brief Internal method to construct parabolic parametrisation out of three hits, using Cramer's rule.
-   *  @param hit1 First hit
-   *  @param hit2 Second hit
-   *  @param hit3 Third hit
-   *  @param a quadratic coefficient
-   *  @param b linear coefficient
-   *  @param c offset
-   */
-  void solveParabola(const PrHit* hit1, const PrHit* hit2, const PrHit* hit3, float& a, float& b, float& c);
-  
-  
-  /// Class to find lower bound of x of PrHit
-  class lowerBoundX {
-  public:
-    bool operator() (const PrHit* lhs, const double testval ) const { return lhs->x() < testval; }
-  };
-
-  /// Class to compare x positions of PrHits
-  class compX {
-  public:
-    bool operator() (const PrHit* lhs, const PrHit* rhs ) const { return lhs->x() < rhs->x(); }
-  };
-
-  /// Class to find lower bound of LHCbIDs of PrHits
-  class lowerBoundLHCbID {
-  public:
-    bool operator() (const PrHit* lhs, const LHCb::LHCbID id ) const { return lhs->id() < id; }
-  };
-  
-  /// Class to compare LHCbIDs of PrHits
-  class compLHCbID {
-  public:
-    bool operator() (const PrHit* lhs, const PrHit* rhs ) const { return lhs->id() < rhs->id(); }
-  };
-
+  /// No concurrent tasks when debugging, as the message streams and histograms are shared
+  bool concurrencyAllowed() const;
   
   
 private:
   std::string     m_inputName;
   std::string     m_outputName;
   std::string     m_hitManagerName;
-  float           m_maxChi2InTrack;
-  float           m_maxIpAtZero;
-  float           m_tolXInf;
-  float           m_tolXSup;
-  unsigned int    m_minXPlanes;
-  float           m_maxChi2PerDoF;
-  bool            m_xOnly;
-  unsigned int    m_maxParabolaSeedHits;
-  
-  float           m_tolTyOffset;
-  float           m_tolTySlope;
+  PrSeedingSearch::Config m_config;  ///< the properties of the search
+  std::string     m_instructionSet;
   
   bool            m_decodeData;
   bool            m_printSettings;
@@ -196,14 +197,17 @@ private:
 
   PrHitManager*   m_hitManager;
   PrGeometryTool* m_geoTool;
+  ILHCbMagnetSvc* m_magFieldSvc;
 
   //== Debugging controls
   std::string     m_debugToolName;
   int             m_wantedKey;
   IPrDebugTool*   m_debugTool;
 
-  std::vector<PrSeedTrack>       m_trackCandidates;
-  std::vector<PrSeedTrack>       m_xCandidates;
+  PrSeedingSearch                m_search;      ///< configured in initialize(), tables rebuilt by the update manager
+  PrSeedingPool<EventData>       m_events;      ///< hits and contexts of the events, reused for their memory
+  std::mutex                     m_hitManagerMutex; ///< the hit manager holds the hits of one event
+  std::mutex                     m_countersMutex;
 
   bool           m_doTiming;
   ISequencerTimerTool* m_timerTool;
@@ -0,0 +1,164 @@
+#ifndef PRSEEDINGTESTEVENT_H
+#define PRSEEDINGTESTEVENT_H 1
+
+// Include files
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "PrSeedingGeometry.h"
+#include "PrSeedingHitStore.h"
+#include "PrSeedingSearch.h"
+
+/** @class PrSeedingTestEvent PrSeedingTestEvent.h
+ *  Synthetic events for the tests of the search: the 24 zones of the T stations, and tracks
+ *  on parabolas in x and lines in y from the region of the origin, with smearing, missing
+ *  hits and noise hits. The same seed gives the same event with all standard libraries.
+ *
+ *  Zone n is in layer n/2, the layers of a station are x, u, v, x; even zones are the upper half.
+ */
+class PrSeedingTestEvent {
+public:
+  /// Track of the output of a search: its hits, by LHCbID, and its parameters
+  struct Track {
+    unsigned int              part;
+    bool                      valid;
+    std::vector<unsigned int> ids;
+    float                     ax, bx, cx, ay, by, chi2;
+
+    bool operator==( const Track& other ) const {
+      return part == other.part && valid == other.valid && ids == other.ids && ax == other.ax && bx == other.bx &&
+             cx == other.cx && ay == other.ay && by == other.by && chi2 == other.chi2;
+    }
+  };
+  typedef std::vector<Track> Tracks;
+
+  static float zRef() { return 8520.; }
+
+  static float zLayer( unsigned int layer ) {
+    static const float z[12] = { 7826., 7896., 7966., 8036., 8508., 8578., 8648., 8718., 9193., 9263., 9333., 9403. };
+    return z[layer];
+  }
+
+  static float dxDyLayer( unsigned int layer ) {
+    const unsigned int k = layer % 4;
+    return 1 == k ? 0.0875f : ( 2 == k ? -0.0875f : 0.f );
+  }
+
+  /// Uniform in [a, b), from the raw generator only
+  static float uniform( std::mt19937& rng, float a, float b ) {
+    return a + ( b - a ) * ( rng() >> 8 ) * ( 1.f / 16777216.f );
+  }
+
+  /// The zones of the T stations
+  static void makeGeometry( PrSeedingGeometry& geometry ) {
+    geometry.clear( zRef() );
+    for ( unsigned int zone = 0; 24 > zone; ++zone ) {
+      const unsigned int layer = zone / 2;
+      geometry.addZone( zLayer( layer ), dxDyLayer( layer ), 0., 0.f == dxDyLayer( layer ) );
+    }
+    geometry.close();
+  }
+
+  /** @brief Fill the hits of an event
+   *  @param hits The hit store, filled for the zones of the geometry
+   *  @param geometry The zones, from makeGeometry()
+   *  @param seed Seed of the event
+   *  @param nTracks Number of tracks
+   *  @param nNoise Number of noise hits per zone
+   */
+  static void fill( PrSeedingHitStore& hits, const PrSeedingGeometry& geometry, unsigned int seed,
+                    unsigned int nTracks, unsigned int nNoise ) {
+    std::mt19937 rng( seed );
+    std::vector<std::vector<float> > xs( geometry.nZones() );
+    for ( unsigned int t = 0; nTracks > t; ++t ) {
+      const unsigned int part = t % 2;
+      const float ax = uniform( rng, -2500., 2500. );
+      const float bx = ax / zRef() + uniform( rng, -0.03, 0.03 );
+      const float cx = uniform( rng, -1e-6, 1e-6 ) * ( ax / 2500. );
+      const float ay = ( 0 == part ? 1.f : -1.f ) * uniform( rng, 50., 2200. );
+      const float by = ay / zRef() + uniform( rng, -0.002, 0.002 );
+      for ( unsigned int layer = 0; 12 > layer; ++layer ) {
+        if ( 0.05f > uniform( rng, 0., 1. ) ) continue;  // missing hit
+        const float dz = zLayer( layer ) - zRef();
+        const float y  = ay + dz * by;
+        xs[2 * layer + part].push_back( ax + dz * ( bx + dz * cx ) - dxDyLayer( layer ) * y + uniform( rng, -0.15, 0.15 ) );
+      }
+    }
+    for ( unsigned int zone = 0; geometry.nZones() > zone; ++zone ) {
+      for ( unsigned int k = 0; nNoise > k; ++k ) xs[zone].push_back( uniform( rng, -3000., 3000. ) );
+      std::sort( xs[zone].begin(), xs[zone].end() );
+    }
+
+    unsigned int nHits = 0;
+    for ( unsigned int zone = 0; geometry.nZones() > zone; ++zone ) nHits += xs[zone].size();
+    hits.clear( geometry.nZones(), nHits );
+    unsigned int id = 0;
+    for ( unsigned int zone = 0; geometry.nZones() > zone; ++zone ) {
+      hits.addZone( geometry.dxDy( zone ), geometry.dzDy( zone ) );
+      for ( std::vector<float>::const_iterator itX = xs[zone].begin(); xs[zone].end() != itX; ++itX ) {
+        hits.addHit( *itX, geometry.z( zone ), 1.f / ( 0.11f * 0.11f ), ++id, geometry.planeCode( zone ), nullptr );
+      }
+    }
+    hits.close();
+  }
+
+  /// The valid tracks of the halves of a search, as PrSeedingXLayers makes the LHCb::Tracks
+  static Tracks tracks( const PrSeedingHitStore& hits, const PrSeedingSearch::EventContext& event ) {
+    Tracks result;
+    for ( unsigned int part = 0; 2 > part; ++part ) add( hits, part, event.halves[part].trackCandidates, false, result );
+    return result;
+  }
+
+  /// All the x projections of the halves of a search, in their order, the clones marked as not valid
+  static Tracks xCandidates( const PrSeedingHitStore& hits, const PrSeedingSearch::EventContext& event ) {
+    Tracks result;
+    for ( unsigned int part = 0; 2 > part; ++part ) add( hits, part, event.halves[part].xCandidates, true, result );
+    return result;
+  }
+
+  /// Search an event in the context, with no hit used before
+  static Tracks search( const PrSeedingSearch& search, const PrSeedingHitStore& hits, PrSeedingSearch::EventContext& event ) {
+    event.start( hits.size() );
+    search.search( hits, event, nullptr );
+    return tracks( hits, event );
+  }
+
+  /// Add the candidates of a half at the end of result, only the valid ones unless all
+  static void add( const PrSeedingHitStore& hits, unsigned int part, const PrSeedCandidates& candidates, bool all,
+                   Tracks& result ) {
+    for ( PrSeedCandidates::const_iterator itT = candidates.begin(); candidates.end() != itT; ++itT ) {
+      if ( !all && !(*itT).valid() ) continue;
+      Track track;
+      track.part  = part;
+      track.valid = (*itT).valid();
+      for ( PrHitIndices::const_iterator itH = (*itT).hits().begin(); (*itT).hits().end() != itH; ++itH ) {
+        track.ids.push_back( hits.id( *itH ).lhcbID() );
+      }
+      track.ax   = (*itT).ax();
+      track.bx   = (*itT).bx();
+      track.cx   = (*itT).cx();
+      track.ay   = (*itT).ay();
+      track.by   = (*itT).by();
+      track.chi2 = (*itT).chi2();
+      result.push_back( track );
+    }
+  }
+
+  /// Number of tracks of a which differ from the ones of b, in order, plus the difference of the sizes
+  static unsigned int nDifferent( const Tracks& a, const Tracks& b ) {
+    unsigned int n = a.size() > b.size() ? a.size() - b.size() : b.size() - a.size();
+    for ( unsigned int k = 0; std::min( a.size(), b.size() ) > k; ++k ) {
+      if ( !( a[k] == b[k] ) ) ++n;
+    }
+    return n;
+  }
+
+  /// Position of the first track of b which differs from the one of a, or the smaller size
+  static unsigned int firstDifferent( const Tracks& a, const Tracks& b ) {
+    unsigned int k = 0;
+    while ( a.size() > k && b.size() > k && a[k] == b[k] ) ++k;
+    return k;
+  }
+};
+#endif // PRSEEDINGTESTEVENT_H
@@ -0,0 +1,78 @@
+// Include files
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "PrSeedingSearch.h"
+#include "PrSeedingTestEvent.h"
+
+//-----------------------------------------------------------------------------
+// Benchmark of the concurrency of PrSeedingSearch: time per event of the search of
+// synthetic events of growing multiplicity, with the halves one after the other, with
+// ConcurrentHalves, and with 4 ThreadsPerHalf working on the chunks of each half. The
+// gain is bounded by the cores of the machine, which are printed. It is built with the
+// tests but is not one of them:
+//
+//   ./bench_PrSeedingSearch
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const unsigned int nRepeat = 20;
+
+  /// Search configuration of a column of the table
+  struct Column {
+    const char*             name;
+    PrSeedingSearch::Config config;
+  };
+
+  /// Time per search of the event in ms, and the number of tracks found
+  double msPerEvent( const PrSeedingSearch& search, const PrSeedingHitStore& hits, PrSeedingSearch::EventContext& context,
+                     unsigned int& nTracks ) {
+    nTracks = PrSeedingTestEvent::search( search, hits, context ).size();  // warm up the memory of the context
+    std::chrono::duration<double, std::milli> time( 0. );
+    for ( unsigned int r = 0; nRepeat > r; ++r ) {
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      context.start( hits.size() );
+      search.search( hits, context, nullptr );
+      time += std::chrono::steady_clock::now() - start;
+    }
+    return time.count() / nRepeat;
+  }
+}
+
+int main() {
+  std::vector<Column> columns( 3 );
+  columns[0].name = "serial";
+  columns[1].name = "halves";
+  columns[1].config.concurrentHalves = true;
+  columns[2].name = "halves x 4";
+  columns[2].config.concurrentHalves = true;
+  columns[2].config.threadsPerHalf   = 4;
+
+  std::printf( "%u cores\n", std::thread::hardware_concurrency() );
+  std::printf( "%6s %6s %7s", "tracks", "hits", "found" );
+  for ( unsigned int c = 0; columns.size() > c; ++c ) std::printf( " %10s", columns[c].name );
+  std::printf( "   [ms per event]\n" );
+
+  PrSeedingHitStore hits;
+  const unsigned int nTracks[4] = { 50, 150, 300, 500 };
+  for ( unsigned int iT = 0; 4 > iT; ++iT ) {
+    unsigned int nFound = 0;
+    std::vector<double> times;
+    for ( unsigned int c = 0; columns.size() > c; ++c ) {
+      PrSeedingSearch search;
+      search.configure( columns[c].config, PrSeedingSimd::best() );
+      PrSeedingTestEvent::makeGeometry( search.geometry() );
+      hits.setBucketWidth( columns[c].config.xBucketWidth );
+      PrSeedingTestEvent::fill( hits, search.geometry(), 20150301 + iT, nTracks[iT], 30 );
+      PrSeedingSearch::EventContext context( search );
+      times.push_back( msPerEvent( search, hits, context, nFound ) );
+    }
+    std::printf( "%6u %6u %7u", nTracks[iT], hits.size(), nFound );
+    for ( unsigned int c = 0; columns.size() > c; ++c ) std::printf( " %10.3f", times[c] );
+    std::printf( "\n" );
+  }
+  return 0;
+}
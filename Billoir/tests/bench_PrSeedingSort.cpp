@@ -0,0 +1,73 @@
+// Include files
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "PrSeedingSort.h"
+
+//-----------------------------------------------------------------------------
+// Benchmark of PrSeedingSort::radixSortByKey: time per element of sorting ranges of
+// hit indices by a float key, as the parabola seed hits and the stereo hits are, with
+// radixSortByKey, forced to radix sort at all sizes, with PrSeedingSort::stableSort and
+// with std::stable_sort, all with the same key( lhs ) < key( rhs ) order. The crossover
+// of the first two gives PrSeedingSort::radixSortLimit. It is built with the tests but
+// is not one of them:
+//
+//   ./bench_PrSeedingSort
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  /// Elements sorted per size, so that each size takes about the same time
+  const unsigned int nElements = 1 << 23;
+
+  template <typename Sort>
+  double nsPerElement( const std::vector<unsigned int>& input, Sort sort ) {
+    std::vector<unsigned int> idx( input.size() );
+    const unsigned int nRepeat = nElements / input.size();
+    std::chrono::duration<double, std::nano> time( 0. );
+    for ( unsigned int r = 0; nRepeat > r; ++r ) {
+      idx = input;
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      sort( idx );
+      time += std::chrono::steady_clock::now() - start;
+    }
+    return time.count() / ( double( nRepeat ) * input.size() );
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140706 );
+  std::uniform_real_distribution<float> flat( -1000., 1000. );
+  PrSeedingArena arena;
+
+  std::printf( "%6s %12s %12s %12s   [ns per element]\n", "size", "radix", "stableSort", "std" );
+  const unsigned int sizes[11] = { 64, 256, 512, 1000, 1500, 2000, 2500, 3000, 5000, 10000, 100000 };
+  for ( unsigned int iS = 0; 11 > iS; ++iS ) {
+    std::vector<float> keys( sizes[iS] );
+    std::vector<unsigned int> input( sizes[iS] );
+    for ( unsigned int i = 0; sizes[iS] > i; ++i ) {
+      keys[i]  = flat( rng );
+      input[i] = i;
+    }
+    const float* data = keys.data();
+    auto key  = [data]( unsigned int i ) -> float { return data[i]; };
+    auto less = [data]( unsigned int lhs, unsigned int rhs ) { return data[lhs] < data[rhs]; };
+
+    const double tRadix = nsPerElement( input, [&]( std::vector<unsigned int>& idx ) {
+        PrSeedingSort::radixSortByKey( idx.begin(), idx.end(), key, arena, 0 );
+        arena.reset();
+      } );
+    const double tStable = nsPerElement( input, [&]( std::vector<unsigned int>& idx ) {
+        PrSeedingSort::stableSort( idx.begin(), idx.end(), less, arena );
+        arena.reset();
+      } );
+    const double tStd = nsPerElement( input, [&]( std::vector<unsigned int>& idx ) {
+        std::stable_sort( idx.begin(), idx.end(), less );
+      } );
+    std::printf( "%6u %12.2f %12.2f %12.2f\n", sizes[iS], tRadix, tStable, tStd );
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+// Include files
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "PrSeedingXBuckets.h"
+
+//-----------------------------------------------------------------------------
+// Benchmark of PrSeedingXBuckets: time per lookup of lowerBound() and of
+// std::lower_bound for zones of 100 to 10000 hits spread over 6 m, with the default
+// bin width of PrSeedingXLayers. It is built with the tests but is not one of them:
+//
+//   ./bench_PrSeedingXBuckets
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const unsigned int nQueries = 1 << 22;
+
+  double nsPerQuery( std::chrono::steady_clock::time_point start ) {
+    return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count() / nQueries;
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140704 );
+  std::uniform_real_distribution<float> flat( -3000., 3000. );
+  const float width = 4.;
+
+  std::vector<float> xs( nQueries );
+  for ( unsigned int k = 0; nQueries > k; ++k ) xs[k] = flat( rng );
+
+  std::printf( "%6s %14s %14s %8s\n", "hits", "buckets [ns]", "lower_bound", "speedup" );
+  const unsigned int sizes[4] = { 100, 1000, 3000, 10000 };
+  for ( unsigned int iS = 0; 4 > iS; ++iS ) {
+    std::vector<float> x( sizes[iS] );
+    for ( unsigned int i = 0; sizes[iS] > i; ++i ) x[i] = flat( rng );
+    std::sort( x.begin(), x.end() );
+    const float* data = x.data();
+    PrSeedingXBuckets buckets;
+    buckets.build( x.size(), [data]( unsigned int i ) { return data[i]; }, width );
+
+    // -- The sums keep the lookups from being optimised away, and must agree
+    unsigned long sumBuckets = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for ( unsigned int k = 0; nQueries > k; ++k ) {
+      sumBuckets += buckets.lowerBound( xs[k], x.size(), [data]( unsigned int i ) { return data[i]; } );
+    }
+    const double tBuckets = nsPerQuery( start );
+
+    unsigned long sumStd = 0;
+    start = std::chrono::steady_clock::now();
+    for ( unsigned int k = 0; nQueries > k; ++k ) sumStd += std::lower_bound( x.begin(), x.end(), xs[k] ) - x.begin();
+    const double tStd = nsPerQuery( start );
+
+    std::printf( "%6u %14.2f %14.2f %8.2f%s\n", sizes[iS], tBuckets, tStd, tStd / tBuckets,
+                 sumBuckets == sumStd ? "" : "  (results differ!)" );
+  }
+  return 0;
+}
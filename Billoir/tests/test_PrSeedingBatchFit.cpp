@@ -0,0 +1,307 @@
+// Include files
+#include <algorithm>
+#include <cfenv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "PrSeedingBatchFit.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingBatchFit: the same fixed set of candidates is fitted with the
+// kernel of every instruction set supported by the CPU, and the parameters, the
+// status and the worst hit must be bit for bit the ones of the scalar kernel.
+// No kernel may raise FE_INVALID or FE_DIVBYZERO, as fitTrack does not.
+//
+// Then tracks with their hits in a PrSeedingHitStore are fitted with fit() at every
+// level, and must give bit for bit the results of the scalar fitTrack, which the
+// seeding used for all fits before the batch fit and still uses for the refits.
+//
+// Last, hits are removed one by one from the tracks, the worst one first as in the outlier
+// removal of the seeding, and the moments downdated for each removed hit must agree with the
+// ones summed again over the remaining hits, as must the refits with either of them.
+//
+// Returns 0 on success, 1 if a level differs or raises, or if the downdated moments or fits do not agree.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const float zRef           = 8520.;
+  const float maxChi2InTrack = 5.5;
+  const float zLayer[12]     = { 7826., 7896., 7966., 8036., 8508., 8578., 8648., 8718., 9193., 9263., 9333., 9403. };
+  const float dzDy           = 0.0036f;
+
+  float dxDyLayer( unsigned int layer ) {
+    const unsigned int k = layer % 4;
+    return 1 == k ? 0.0875f : ( 2 == k ? -0.0875f : 0.f );
+  }
+
+  /// Uniform in [a, b), from the raw generator only, to be the same with all standard libraries
+  float uniform( std::mt19937& rng, float a, float b ) {
+    return a + ( b - a ) * ( rng() >> 8 ) * ( 1.f / 16777216.f );
+  }
+
+  /// Blocks of candidates on parabolas, with smearing, missing layers, outliers and start parameters off the truth.
+  /// In every third block only the first lanes hold candidates, the others are padding as in PrSeedingBatchFit::fit
+  std::vector<PrSeedingBatchFit::Block> makeBlocks( unsigned int nBlocks ) {
+    std::mt19937 rng( 20140212 );
+    std::vector<PrSeedingBatchFit::Block> blocks( nBlocks );
+    for ( unsigned int iB = 0; nBlocks > iB; ++iB ) {
+      PrSeedingBatchFit::Block& b = blocks[iB];
+      const unsigned int stride = PrSeedingBatchFit::blockSize;
+      b.nHits = 12;
+      b.x.assign( b.nHits * stride, 0.f );
+      b.z.assign( b.nHits * stride, 0.f );
+      b.w.assign( b.nHits * stride, 0.f );
+      b.dxDy.assign( b.nHits * stride, 0.f );
+      b.dzDy.assign( b.nHits * stride, 0.f );
+      for ( unsigned int l = 0; stride > l; ++l ) {
+        if ( 1 == iB % 3 && 5 <= l ) {
+          b.ax[l] = b.bx[l] = b.cx[l] = b.ay[l] = b.by[l] = 0.;
+          b.used[l]  = 0;
+          b.ok[l]    = 0;
+          b.worst[l] = 0;
+          continue;
+        }
+        const float ax = uniform( rng, -2500., 2500. );
+        const float bx = uniform( rng, -0.25, 0.25 );
+        const float cx = uniform( rng, -2e-7, 2e-7 );
+        const float ay = uniform( rng, -2200., 2200. );
+        const float by = ay / zRef + uniform( rng, -0.002, 0.002 );
+        unsigned int j = 0;
+        for ( unsigned int layer = 0; 12 > layer; ++layer ) {
+          if ( 0.1f > uniform( rng, 0., 1. ) ) continue;  // missing hit, the lane is padded
+          const float y  = ay + ( zLayer[layer] - zRef ) * by;
+          const float z  = zLayer[layer] + dzDy * y;
+          const float dz = z - zRef;
+          float x = ax + dz * ( bx + dz * cx ) - dxDyLayer( layer ) * y + uniform( rng, -0.15, 0.15 );
+          if ( 0.05f > uniform( rng, 0., 1. ) ) x += uniform( rng, -5., 5. );  // outlier
+          const unsigned int k = j * stride + l;
+          b.x[k]    = x;
+          b.z[k]    = zLayer[layer];
+          b.w[k]    = 1.f / ( 0.11f * 0.11f );
+          b.dxDy[k] = dxDyLayer( layer );
+          b.dzDy[k] = dzDy;
+          ++j;
+        }
+        b.ax[l]    = ax + uniform( rng, -1., 1. );
+        b.bx[l]    = bx + uniform( rng, -1e-3, 1e-3 );
+        b.cx[l]    = 0.;
+        b.ay[l]    = 0.;
+        b.by[l]    = 0.;
+        b.used[l]  = -1;
+        b.ok[l]    = 0;
+        b.worst[l] = 0;
+      }
+    }
+    return blocks;
+  }
+
+  bool sameResult( const PrSeedingBatchFit::Block& lhs, const PrSeedingBatchFit::Block& rhs, unsigned int n ) {
+    const size_t nF = n * sizeof( float );
+    const size_t nI = n * sizeof( int );
+    return 0 == std::memcmp( lhs.ax, rhs.ax, nF ) && 0 == std::memcmp( lhs.bx, rhs.bx, nF ) &&
+           0 == std::memcmp( lhs.cx, rhs.cx, nF ) && 0 == std::memcmp( lhs.ay, rhs.ay, nF ) &&
+           0 == std::memcmp( lhs.by, rhs.by, nF ) && 0 == std::memcmp( lhs.ok, rhs.ok, nI ) &&
+           0 == std::memcmp( lhs.worst, rhs.worst, nI );
+  }
+
+  /// Hit of a generated track, before it is put in the zone of its layer
+  struct GenHit {
+    unsigned int layer;
+    float        x;
+    unsigned int track;
+    unsigned int pos;  ///< position in the track
+
+    bool operator<( const GenHit& rhs ) const { return layer < rhs.layer || ( layer == rhs.layer && x < rhs.x ); }
+  };
+
+  /// Tracks as in makeBlocks, with their hits in a store of one zone per layer. Every fourth
+  /// track misses half of its layers, so that some fits have too few x hits and fail.
+  void makeTracks( unsigned int nTracks, PrSeedingHitStore& store, std::vector<PrSeedCandidate>& tracks ) {
+    std::mt19937 rng( 20140626 );
+    std::vector<GenHit> hits;
+    std::vector<unsigned int> nHits( nTracks, 0 );
+    tracks.clear();
+    for ( unsigned int t = 0; nTracks > t; ++t ) {
+      const float ax = uniform( rng, -2500., 2500. );
+      const float bx = uniform( rng, -0.25, 0.25 );
+      const float cx = uniform( rng, -2e-7, 2e-7 );
+      const float ay = uniform( rng, -2200., 2200. );
+      const float by = ay / zRef + uniform( rng, -0.002, 0.002 );
+      const float missing = ( 0 == t % 4 ) ? 0.5f : 0.1f;
+      for ( unsigned int layer = 0; 12 > layer; ++layer ) {
+        if ( missing > uniform( rng, 0., 1. ) ) continue;
+        const float y  = ay + ( zLayer[layer] - zRef ) * by;
+        const float dz = zLayer[layer] + dzDy * y - zRef;
+        float x = ax + dz * ( bx + dz * cx ) - dxDyLayer( layer ) * y + uniform( rng, -0.15, 0.15 );
+        if ( 0.05f > uniform( rng, 0., 1. ) ) x += uniform( rng, -5., 5. );  // outlier
+        const GenHit hit = { layer, x, t, nHits[t]++ };
+        hits.push_back( hit );
+      }
+      tracks.push_back( PrSeedCandidate( 0, zRef ) );
+      tracks.back().setParameters( ax + uniform( rng, -1., 1. ), bx + uniform( rng, -1e-3, 1e-3 ), 0., 0., 0. );
+    }
+
+    // -- The hits of a zone are sorted by x in the store
+    std::sort( hits.begin(), hits.end() );
+    std::vector<std::vector<unsigned int> > index( nTracks );
+    for ( unsigned int t = 0; nTracks > t; ++t ) index[t].resize( nHits[t] );
+    store.clear( 12, hits.size() );
+    std::vector<GenHit>::const_iterator itH = hits.begin();
+    for ( unsigned int layer = 0; 12 > layer; ++layer ) {
+      store.addZone( dxDyLayer( layer ), dzDy );
+      for ( ; hits.end() != itH && layer == (*itH).layer; ++itH ) {
+        index[(*itH).track][(*itH).pos] = store.size();
+        store.addHit( (*itH).x, zLayer[layer], 1.f / ( 0.11f * 0.11f ), store.size(), layer, nullptr );
+      }
+    }
+    store.close();
+    for ( unsigned int t = 0; nTracks > t; ++t ) {
+      for ( unsigned int pos = 0; nHits[t] > pos; ++pos ) tracks[t].addHit( index[t][pos] );
+    }
+  }
+
+  /// The moments agree within tol of the ones of the same power of z of all hits, summed with |z|
+  bool closeMoments( const PrSeedingBatchFit::Moments& lhs, const PrSeedingBatchFit::Moments& rhs,
+                     const PrSeedingBatchFit::Moments& scale, double tol ) {
+    const double l[13] = { lhs.s0, lhs.sz, lhs.sz2, lhs.sz3, lhs.sz4, lhs.a0, lhs.az, lhs.az2, lhs.az3, lhs.az4, lhs.t0, lhs.tz, lhs.tz2 };
+    const double r[13] = { rhs.s0, rhs.sz, rhs.sz2, rhs.sz3, rhs.sz4, rhs.a0, rhs.az, rhs.az2, rhs.az3, rhs.az4, rhs.t0, rhs.tz, rhs.tz2 };
+    const double m[13] = { scale.a0, scale.az, scale.az2, scale.az3, scale.az4, scale.a0, scale.az, scale.az2, scale.az3, scale.az4,
+                           scale.a0, scale.az, scale.az2 };
+    for ( unsigned int k = 0; 13 > k; ++k ) {
+      if ( std::fabs( l[k] - r[k] ) > tol * m[k] ) return false;
+    }
+    return true;
+  }
+
+  /// Moments of all hits of the track with |z - zRef|, the scale of the rounding of their sums
+  PrSeedingBatchFit::Moments absMoments( const PrSeedingHitStore& store, const PrSeedCandidate& track ) {
+    PrSeedingBatchFit::Moments m;
+    for ( PrHitIndices::const_iterator itH = track.hits().begin(); track.hits().end() != itH; ++itH ) {
+      const double w = store.w( *itH );
+      const double z = std::fabs( store.z( *itH ) - zRef );
+      m.a0  += w;
+      m.az  += w * z;
+      m.az2 += w * z * z;
+      m.az3 += w * z * z * z;
+      m.az4 += w * z * z * z * z;
+    }
+    return m;
+  }
+
+  unsigned int nXHits( const PrSeedingHitStore& store, const PrSeedCandidate& track ) {
+    unsigned int n = 0;
+    for ( PrHitIndices::const_iterator itH = track.hits().begin(); track.hits().end() != itH; ++itH ) {
+      if ( 0 == store.dxDy( *itH ) ) ++n;
+    }
+    return n;
+  }
+
+  /// Largest difference of the distances of the hits of the track to the two fits of it
+  float maxDistance( const PrSeedingHitStore& store, const PrSeedCandidate& lhs, const PrSeedCandidate& rhs ) {
+    float d = 0.;
+    for ( PrHitIndices::const_iterator itH = lhs.hits().begin(); lhs.hits().end() != itH; ++itH ) {
+      d = std::max( d, std::fabs( lhs.distance( store, *itH ) - rhs.distance( store, *itH ) ) );
+    }
+    return d;
+  }
+
+  bool sameParameters( const PrSeedCandidate& lhs, const PrSeedCandidate& rhs ) {
+    const float l[5] = { lhs.ax(), lhs.bx(), lhs.cx(), lhs.ay(), lhs.by() };
+    const float r[5] = { rhs.ax(), rhs.bx(), rhs.cx(), rhs.ay(), rhs.by() };
+    return 0 == std::memcmp( l, r, sizeof( l ) );
+  }
+}
+
+int main() {
+  const unsigned int nBlocks = 300;
+  const std::vector<PrSeedingBatchFit::Block> input = makeBlocks( nBlocks );
+
+  int status = 0;
+  for ( int l = PrSeedingSimd::Scalar; PrSeedingSimd::AVX512 >= l; ++l ) {
+    const PrSeedingSimd::Level level = PrSeedingSimd::Level( l );
+    if ( !PrSeedingSimd::supported( level ) ) {
+      std::printf( "%-8s not supported by this CPU, skipped\n", PrSeedingSimd::name( level ) );
+      continue;
+    }
+    // -- Every other block is only filled up to the width of the kernel, as the last block of a batch
+    unsigned int nDiffer = 0;
+    unsigned int nRaised = 0;
+    for ( unsigned int iB = 0; nBlocks > iB; ++iB ) {
+      PrSeedingBatchFit::Block block = input[iB];
+      const unsigned int n = ( 0 == iB % 2 ) ? (unsigned int)PrSeedingBatchFit::blockSize : PrSeedingSimd::lanes( level );
+      PrSeedingBatchFit::Block ref = input[iB];
+      PrSeedingBatchFit::kernel( PrSeedingSimd::Scalar )( ref, n, zRef, maxChi2InTrack );
+      std::feclearexcept( FE_ALL_EXCEPT );
+      PrSeedingBatchFit::kernel( level )( block, n, zRef, maxChi2InTrack );
+      if ( 0 != std::fetestexcept( FE_INVALID | FE_DIVBYZERO ) ) ++nRaised;
+      if ( !sameResult( block, ref, n ) ) ++nDiffer;
+    }
+    std::printf( "%-8s %u of %u blocks differ from the scalar fit, %u raise FE_INVALID or FE_DIVBYZERO\n",
+                 PrSeedingSimd::name( level ), nDiffer, nBlocks, nRaised );
+    if ( 0 != nDiffer || 0 != nRaised ) status = 1;
+  }
+
+  // -- 1005 tracks: the last block of the batch is partial
+  PrSeedingHitStore store;
+  std::vector<PrSeedCandidate> tracks;
+  makeTracks( 1005, store, tracks );
+  for ( int l = PrSeedingSimd::Scalar; PrSeedingSimd::AVX512 >= l; ++l ) {
+    const PrSeedingSimd::Level level = PrSeedingSimd::Level( l );
+    if ( !PrSeedingSimd::supported( level ) ) continue;
+    PrSeedingBatchFit batchFit;
+    batchFit.setLevel( level );
+    std::vector<PrSeedCandidate> batch( tracks );
+    batchFit.fit( store, zRef, maxChi2InTrack, batch.data(), batch.size() );
+
+    unsigned int nDiffer = 0;
+    unsigned int nOk     = 0;
+    for ( unsigned int i = 0; tracks.size() > i; ++i ) {
+      PrSeedCandidate ref( tracks[i] );
+      unsigned int worst = 0;
+      const bool ok = PrSeedingBatchFit::fitTrack( store, zRef, maxChi2InTrack, ref, worst );
+      if ( ok ) ++nOk;
+      if ( ok != batchFit.ok( i ) || worst != batchFit.worst( i ) || !sameParameters( ref, batch[i] ) ) ++nDiffer;
+    }
+    std::printf( "%-8s %u of %u tracks differ from fitTrack, which fits %u of them\n",
+                 PrSeedingSimd::name( level ), nDiffer, (unsigned int)tracks.size(), nOk );
+    if ( 0 != nDiffer ) status = 1;
+  }
+
+  // -- Up to 4 hits removed from each track, the worst first, as long as 6 hits and 4 x hits are left,
+  //    as the parabola of the first iteration is not defined with fewer x hits. The refit with
+  //    the downdated moments must give the one of fitTrack, which sums them again, up to its rounding:
+  //    the same status, and the hits within a tenth of their resolution of the same parabola
+  unsigned int nRemoved    = 0;
+  unsigned int nMoments    = 0;
+  unsigned int nFitsDiffer = 0;
+  float        maxDiff     = 0.;
+  for ( unsigned int i = 0; tracks.size() > i; ++i ) {
+    PrSeedCandidate track( tracks[i] );
+    unsigned int worst = 0;
+    PrSeedingBatchFit::fitTrack( store, zRef, maxChi2InTrack, track, worst );
+    const PrSeedingBatchFit::Moments scale = absMoments( store, track );
+    PrSeedingBatchFit::Moments moments( store, zRef, track );
+    for ( unsigned int k = 0; 4 > k && 6 < track.hits().size(); ++k ) {
+      if ( 4 + ( 0 == store.dxDy( track.hits()[worst] ) ? 1u : 0u ) > nXHits( store, track ) ) break;
+      moments.remove( store, zRef, track.hits()[worst] );
+      track.hits().erase( track.hits().begin() + worst );
+      ++nRemoved;
+      if ( !closeMoments( moments, PrSeedingBatchFit::Moments( store, zRef, track ), scale, 1e-12 ) ) ++nMoments;
+
+      PrSeedCandidate resummed( track );
+      unsigned int worstResummed = 0;
+      const bool okResummed = PrSeedingBatchFit::fitTrack( store, zRef, maxChi2InTrack, resummed, worstResummed );
+      const bool ok = PrSeedingBatchFit::fitTrack( store, zRef, maxChi2InTrack, track, moments, worst );
+      if ( ok ) maxDiff = std::max( maxDiff, maxDistance( store, track, resummed ) );
+      if ( ok != okResummed || ( ok && 0.011f < maxDistance( store, track, resummed ) ) ) ++nFitsDiffer;
+    }
+  }
+  std::printf( "%u hits removed: %u downdated moments and %u refits differ from the ones summed again, "
+               "largest difference of a hit %.2g mm\n", nRemoved, nMoments, nFitsDiffer, maxDiff );
+  if ( 0 != nMoments || 0 != nFitsDiffer ) status = 1;
+  return status;
+}
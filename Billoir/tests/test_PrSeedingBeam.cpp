@@ -0,0 +1,105 @@
+// Include files
+#include <cstdio>
+#include <vector>
+
+#include "tbb/global_control.h"
+
+#include "PrSeedingSearch.h"
+#include "PrSeedingTestEvent.h"
+
+//-----------------------------------------------------------------------------
+// Test of MaxXCandidatesPerFirstHit, the beam of the x search: fixed synthetic events
+// are searched with beams of 1, 2 and 4 candidates per first hit, with a beam wider than
+// any pool and without a beam. Then:
+//
+// - without a beam, and with a beam no pool fills, no candidate is pruned and the tracks
+//   are the ones of the search without a beam;
+// - the narrower the beam, the more candidates are pruned, and the fewer tracks are found;
+// - the pruned candidates, which XCandidatesPruned counts, are summed over the halves and
+//   the chunks into the first half: ConcurrentHalves and ThreadsPerHalf count as many as
+//   the serial search, and find the same tracks.
+//
+// Returns 0 on success, 1 if a count or track differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const unsigned int nEvents = 4;
+
+  unsigned int seedOf( unsigned int event ) { return 20140701 + event; }
+  unsigned int tracksOf( unsigned int event ) { return 100 + 150 * event; }
+
+  /// Result of the search of all the events with a beam
+  struct Beam {
+    unsigned int                           nPruned;
+    std::vector<PrSeedingTestEvent::Tracks> tracks;
+
+    unsigned int nTracks() const {
+      unsigned int n = 0;
+      for ( unsigned int e = 0; tracks.size() > e; ++e ) n += tracks[e].size();
+      return n;
+    }
+  };
+
+  /// Search all the events with a beam of maxPool candidates per first hit, 0 for no beam
+  Beam searchAll( unsigned int maxPool, bool concurrent ) {
+    PrSeedingSearch::Config config;
+    config.maxXCandidatesPerFirstHit = maxPool;
+    config.concurrentHalves          = concurrent;
+    config.threadsPerHalf            = concurrent ? 2 : 1;
+    PrSeedingSearch search;
+    search.configure( config, PrSeedingSimd::best() );
+    PrSeedingTestEvent::makeGeometry( search.geometry() );
+
+    PrSeedingHitStore hits;
+    hits.setBucketWidth( config.xBucketWidth );
+    PrSeedingSearch::EventContext context( search );
+    Beam beam;
+    beam.nPruned = 0;
+    for ( unsigned int e = 0; nEvents > e; ++e ) {
+      PrSeedingTestEvent::fill( hits, search.geometry(), seedOf( e ), tracksOf( e ), 30 );
+      beam.tracks.push_back( PrSeedingTestEvent::search( search, hits, context ) );
+      beam.nPruned += context.halves[0].nBeamPruned;
+    }
+    return beam;
+  }
+
+  /// Number of events whose tracks differ
+  unsigned int nDifferent( const Beam& reference, const Beam& beam ) {
+    unsigned int n = 0;
+    for ( unsigned int e = 0; reference.tracks.size() > e; ++e ) {
+      if ( 0 != PrSeedingTestEvent::nDifferent( reference.tracks[e], beam.tracks[e] ) ) ++n;
+    }
+    return n;
+  }
+}
+
+int main() {
+  tbb::global_control threads( tbb::global_control::max_allowed_parallelism, 4 );
+
+  unsigned int nFailed = 0;
+  const Beam unlimited = searchAll( 0, false );
+  std::printf( "no beam: %u tracks, %u candidates pruned\n", unlimited.nTracks(), unlimited.nPruned );
+  if ( 0 != unlimited.nPruned ) ++nFailed;
+
+  const Beam wide = searchAll( 1000, false );
+  std::printf( "beam of 1000: %u tracks, %u candidates pruned, %u events differ from no beam\n", wide.nTracks(),
+               wide.nPruned, nDifferent( unlimited, wide ) );
+  if ( 0 != wide.nPruned || 0 != nDifferent( unlimited, wide ) ) ++nFailed;
+
+  const unsigned int maxPools[3] = { 4, 2, 1 };
+  unsigned int nPrunedBefore = 0;
+  unsigned int nTracksBefore = unlimited.nTracks();
+  for ( unsigned int iP = 0; 3 > iP; ++iP ) {
+    const Beam serial     = searchAll( maxPools[iP], false );
+    const Beam concurrent = searchAll( maxPools[iP], true );
+    std::printf( "beam of %u: %u tracks, %u candidates pruned; concurrent: %u tracks, %u candidates pruned, "
+                 "%u events differ\n", maxPools[iP], serial.nTracks(), serial.nPruned, concurrent.nTracks(),
+                 concurrent.nPruned, nDifferent( serial, concurrent ) );
+    if ( !( serial.nPruned > nPrunedBefore ) || serial.nTracks() > nTracksBefore ) ++nFailed;
+    if ( serial.nPruned != concurrent.nPruned || 0 != nDifferent( serial, concurrent ) ) ++nFailed;
+    nPrunedBefore = serial.nPruned;
+    nTracksBefore = serial.nTracks();
+  }
+  return 0 == nFailed ? 0 : 1;
+}
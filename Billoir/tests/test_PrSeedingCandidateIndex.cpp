@@ -0,0 +1,188 @@
+// Include files
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "PrSeedingCandidateIndex.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingCandidateIndex: the row of each hit must be the candidates using it,
+// found by a scan of all of them, in increasing order; the index is built again for the
+// next event, smaller or larger, and for candidates without hits. Then the clone removal
+// of findXProjections2, which only compares the candidates sharing at least 3 hits found
+// through the index, must invalidate the same candidates as the loop over all the pairs
+// it replaced, on sets of candidates built from a few tracks so that most of them share hits.
+//
+// Returns 0 on success, 1 if a row or a clone differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  /// The parts of PrSeedCandidate the index and the clone removal read, hits sorted
+  struct Candidate {
+    std::vector<unsigned int> m_hits;
+    float                     chi2PerDoF;
+    bool                      valid;
+
+    const std::vector<unsigned int>& hits() const { return m_hits; }
+  };
+  typedef std::vector<Candidate> Candidates;
+
+  /// Candidates taking most of the hits of a few tracks, and some other hits
+  Candidates makeCandidates( std::mt19937& rng, unsigned int nHits, unsigned int nTracks, unsigned int nCandidates ) {
+    std::vector<std::vector<unsigned int> > tracks( nTracks );
+    for ( unsigned int t = 0; nTracks > t; ++t ) {
+      for ( unsigned int k = 0; 12 > k; ++k ) tracks[t].push_back( rng() % nHits );
+    }
+    Candidates candidates( nCandidates );
+    for ( unsigned int c = 0; nCandidates > c; ++c ) {
+      const std::vector<unsigned int>& track = tracks[rng() % nTracks];
+      std::vector<unsigned int>& hits = candidates[c].m_hits;
+      for ( unsigned int k = 0; track.size() > k; ++k ) {
+        if ( 0 != rng() % 3 ) hits.push_back( track[k] );
+      }
+      for ( unsigned int k = rng() % 4; 0 < k; --k ) hits.push_back( rng() % nHits );
+      std::sort( hits.begin(), hits.end() );
+      hits.erase( std::unique( hits.begin(), hits.end() ), hits.end() );
+      candidates[c].chi2PerDoF = 0.25f * ( rng() % 8 );  // -- ties too
+      candidates[c].valid      = true;
+    }
+    return candidates;
+  }
+
+  /// Number of hits of the rows which differ from a scan of the candidates
+  unsigned int nWrongRows( const PrSeedingCandidateIndex& index, const Candidates& candidates, unsigned int nHits ) {
+    unsigned int n = 0;
+    std::vector<unsigned int> expected;
+    for ( unsigned int hit = 0; nHits > hit; ++hit ) {
+      expected.clear();
+      for ( unsigned int c = 0; candidates.size() > c; ++c ) {
+        const std::vector<unsigned int>& hits = candidates[c].hits();
+        if ( std::binary_search( hits.begin(), hits.end(), hit ) ) expected.push_back( c );
+      }
+      if ( index.end( hit ) - index.begin( hit ) != (long)expected.size() ||
+           !std::equal( expected.begin(), expected.end(), index.begin( hit ) ) ) ++n;
+    }
+    return n;
+  }
+
+  /// The merge of the clone removal: true if the two candidates share more than 2 hits
+  bool clones( const Candidate& c1, const Candidate& c2 ) {
+    unsigned int nCommon = 0;
+    std::vector<unsigned int>::const_iterator itH1 = c1.hits().begin();
+    std::vector<unsigned int>::const_iterator itH2 = c2.hits().begin();
+    while ( itH1 != c1.hits().end() && itH2 != c2.hits().end() ) {
+      if ( *itH1 == *itH2 ) {
+        ++nCommon;
+        ++itH1;
+        ++itH2;
+      } else if ( *itH1 < *itH2 ) {
+        ++itH1;
+      } else {
+        ++itH2;
+      }
+    }
+    return nCommon > 2;
+  }
+
+  /// The rules of the clone removal for a pair of clones
+  void removeClone( Candidate& c1, Candidate& c2 ) {
+    if ( c1.hits().size() > c2.hits().size() ) {
+      c2.valid = false;
+    } else if ( c1.hits().size() < c2.hits().size() ) {
+      c1.valid = false;
+    } else if ( c1.chi2PerDoF < c2.chi2PerDoF ) {
+      c2.valid = false;
+    } else {
+      c1.valid = false;
+    }
+  }
+
+  /// The clone removal before the index: all the later candidates are compared
+  void removeClonesBruteForce( Candidates& candidates ) {
+    for ( unsigned int i1 = 0; candidates.size() > i1; ++i1 ) {
+      if ( !candidates[i1].valid ) continue;
+      for ( unsigned int i2 = i1 + 1; candidates.size() > i2; ++i2 ) {
+        if ( !candidates[i2].valid ) continue;
+        if ( clones( candidates[i1], candidates[i2] ) ) removeClone( candidates[i1], candidates[i2] );
+      }
+    }
+  }
+
+  /// The clone removal of findXProjections2: only the later candidates sharing at least 3 hits
+  void removeClonesIndexed( Candidates& candidates, unsigned int nHits, PrSeedingCandidateIndex& index ) {
+    index.build( candidates, nHits );
+    std::vector<unsigned int> nShared( candidates.size(), 0 );
+    std::vector<unsigned int> sharing;
+    for ( unsigned int i1 = 0; candidates.size() > i1; ++i1 ) {
+      if ( !candidates[i1].valid ) continue;
+      sharing.clear();
+      const std::vector<unsigned int>& hits = candidates[i1].hits();
+      for ( std::vector<unsigned int>::const_iterator itH = hits.begin(); hits.end() != itH; ++itH ) {
+        for ( const unsigned int* itC = index.begin( *itH ); index.end( *itH ) != itC; ++itC ) {
+          if ( i1 < *itC && 0 == nShared[*itC]++ ) sharing.push_back( *itC );
+        }
+      }
+      unsigned int nSharing = 0;
+      for ( unsigned int k = 0; sharing.size() > k; ++k ) {
+        if ( 2 < nShared[sharing[k]] ) sharing[nSharing++] = sharing[k];
+        nShared[sharing[k]] = 0;
+      }
+      std::sort( sharing.begin(), sharing.begin() + nSharing );
+      for ( unsigned int k = 0; nSharing > k; ++k ) {
+        Candidate& c2 = candidates[sharing[k]];
+        if ( !c2.valid ) continue;
+        if ( clones( candidates[i1], c2 ) ) removeClone( candidates[i1], c2 );
+      }
+    }
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140715 );
+  PrSeedingCandidateIndex index;
+  unsigned int nFailed = 0;
+
+  // -- Events of different sizes, with the same index
+  const unsigned int nHits[5]       = { 500, 50, 3000, 1, 500 };
+  const unsigned int nTracks[5]     = { 20, 3, 100, 1, 5 };
+  const unsigned int nCandidates[5] = { 200, 30, 1000, 0, 300 };
+  unsigned int nClones = 0;
+  unsigned int nAll    = 0;
+  for ( unsigned int e = 0; 5 > e; ++e ) {
+    const Candidates candidates = makeCandidates( rng, nHits[e], nTracks[e], nCandidates[e] );
+    index.build( candidates, nHits[e] );
+    const unsigned int nRows = nWrongRows( index, candidates, nHits[e] );
+    if ( 0 != nRows ) {
+      std::printf( "event %u: %u of %u rows differ from the scan of the candidates\n", e, nRows, nHits[e] );
+      ++nFailed;
+    }
+
+    Candidates bruteForce( candidates );
+    Candidates indexed( candidates );
+    removeClonesBruteForce( bruteForce );
+    removeClonesIndexed( indexed, nHits[e], index );
+    for ( unsigned int c = 0; candidates.size() > c; ++c ) {
+      if ( bruteForce[c].valid != indexed[c].valid ) {
+        std::printf( "event %u: candidate %u is %s by the loop over all pairs, %s with the index\n", e, c,
+                     bruteForce[c].valid ? "kept" : "removed", indexed[c].valid ? "kept" : "removed" );
+        ++nFailed;
+      }
+      if ( !bruteForce[c].valid ) ++nClones;
+    }
+    nAll += candidates.size();
+  }
+
+  // -- Candidates without hits
+  Candidates empty( 10 );
+  index.build( empty, 100 );
+  if ( 0 != nWrongRows( index, empty, 100 ) ) {
+    std::printf( "the rows of candidates without hits are not empty\n" );
+    ++nFailed;
+  }
+
+  std::printf( "%u candidates, %u of them clones: %u checks failed\n", nAll, nClones, nFailed );
+  if ( 0 == nClones ) ++nFailed;
+  return 0 == nFailed ? 0 : 1;
+}
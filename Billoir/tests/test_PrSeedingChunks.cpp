@@ -0,0 +1,115 @@
+// Include files
+#include <cstdio>
+#include <vector>
+
+#include "tbb/global_control.h"
+
+#include "PrSeedingSearch.h"
+#include "PrSeedingTestEvent.h"
+
+//-----------------------------------------------------------------------------
+// Test of ThreadsPerHalf: fixed synthetic events are searched with the first hits
+// of the first case of a half cut in chunks searched as tasks, and without. The x
+// projections, which findXProjections2 gathers from the chunks before it sorts them and
+// removes the clones, must be the ones of the search without chunks: the same candidates
+// in the same order, with the same ones marked as clones. The tracks must be the same too.
+// Not with ParallelAllCases, whose chunks do not see the hits used by the ones before.
+//
+// Returns 0 on success, 1 if a candidate or track differs, or if no event was searched in chunks.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const unsigned int nEvents = 8;
+
+  unsigned int seedOf( unsigned int event ) { return 20140626 + event; }
+  unsigned int tracksOf( unsigned int event ) { return 50 + 50 * event; }
+
+  /// Search with the given threads per half, x projections only or not
+  struct Setup {
+    Setup( unsigned int threads, bool xOnly ) : search( make( threads, xOnly ) ), context( search ) {}
+
+    static PrSeedingSearch make( unsigned int threads, bool xOnly ) {
+      PrSeedingSearch::Config config;
+      config.threadsPerHalf = threads;
+      config.xOnly          = xOnly;
+      PrSeedingSearch search;
+      search.configure( config, PrSeedingSimd::best() );
+      PrSeedingTestEvent::makeGeometry( search.geometry() );
+      return search;
+    }
+
+    PrSeedingSearch               search;
+    PrSeedingSearch::EventContext context;
+  };
+
+  /// The first case of a half was searched in chunks: they hold x candidates
+  bool searchedInChunks( const PrSeedingSearch::EventContext& context ) {
+    unsigned int n = 0;
+    for ( unsigned int part = 0; 2 > part; ++part ) {
+      for ( unsigned int c = 0; context.chunks[part].size() > c; ++c ) n += context.chunks[part][c]->xCandidates.size();
+    }
+    return 0 < n;
+  }
+
+  unsigned int nValid( const PrSeedingTestEvent::Tracks& tracks ) {
+    unsigned int n = 0;
+    for ( unsigned int k = 0; tracks.size() > k; ++k ) {
+      if ( tracks[k].valid ) ++n;
+    }
+    return n;
+  }
+}
+
+int main() {
+  tbb::global_control threads( tbb::global_control::max_allowed_parallelism, 4 );
+
+  Setup xSerial( 1, true );
+  Setup serial( 1, false );
+  PrSeedingHitStore hits;
+  hits.setBucketWidth( serial.search.config().xBucketWidth );
+
+  unsigned int nFailed = 0;
+  const unsigned int nThreads[2] = { 2, 4 };
+  for ( unsigned int iT = 0; 2 > iT; ++iT ) {
+    Setup xChunked( nThreads[iT], true );
+    Setup chunked( nThreads[iT], false );
+    unsigned int nCandidates = 0;
+    unsigned int nClones     = 0;
+    unsigned int nTracks     = 0;
+    unsigned int nDiffer     = 0;
+    unsigned int nInChunks   = 0;
+    for ( unsigned int e = 0; nEvents > e; ++e ) {
+      PrSeedingTestEvent::fill( hits, serial.search.geometry(), seedOf( e ), tracksOf( e ), 30 );
+
+      // -- The x projections, after the sort and the clone removal
+      PrSeedingTestEvent::search( xSerial.search, hits, xSerial.context );
+      PrSeedingTestEvent::search( xChunked.search, hits, xChunked.context );
+      const PrSeedingTestEvent::Tracks reference = PrSeedingTestEvent::xCandidates( hits, xSerial.context );
+      const PrSeedingTestEvent::Tracks candidates = PrSeedingTestEvent::xCandidates( hits, xChunked.context );
+      if ( searchedInChunks( xChunked.context ) ) ++nInChunks;
+      nCandidates += reference.size();
+      nClones     += reference.size() - nValid( reference );
+      unsigned int n = PrSeedingTestEvent::nDifferent( reference, candidates );
+      if ( 0 != n ) {
+        std::printf( "%u threads, event %u: %u of %u x candidates differ, the first one is candidate %u\n",
+                     nThreads[iT], e, n, (unsigned int)reference.size(), PrSeedingTestEvent::firstDifferent( reference, candidates ) );
+        ++nDiffer;
+      }
+
+      // -- The tracks
+      const PrSeedingTestEvent::Tracks tracks = PrSeedingTestEvent::search( serial.search, hits, serial.context );
+      nTracks += tracks.size();
+      n = PrSeedingTestEvent::nDifferent( tracks, PrSeedingTestEvent::search( chunked.search, hits, chunked.context ) );
+      if ( 0 != n ) {
+        std::printf( "%u threads, event %u: %u of %u tracks differ\n", nThreads[iT], e, n, (unsigned int)tracks.size() );
+        ++nDiffer;
+      }
+    }
+    std::printf( "%u threads per half, %u events, %u searched in chunks: %u x candidates, %u of them clones, "
+                 "%u tracks, %u events differ\n", nThreads[iT], nEvents, nInChunks, nCandidates, nClones, nTracks, nDiffer );
+    nFailed += nDiffer;
+    if ( 0 == nInChunks ) ++nFailed;
+  }
+  return 0 == nFailed ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Include files
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "PrSeedingClosestHit.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingClosestHit: the hits of several zones are searched for groups of
+// predictions with the kernel of every instruction set supported by the CPU, and the
+// closest hits must be the ones of the hit by hit scan(), which is the scalar level.
+//
+// The positions of the hits are on a grid of 0.25 mm and the predictions on a grid of
+// 0.125 mm, so that there are hits at the same x and predictions half way between two
+// hits: the ties must go to the first hit. The groups are up to 40 predictions around
+// the same x, more than the kernel searches in one pass.
+//
+// Returns 0 on success, 1 if a level differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const float maxDist = 10.;
+
+  /// Hits of nZones zones, sorted by x in each zone, with the first hit of each zone in begin
+  std::vector<float> makeHits( std::mt19937& rng, unsigned int nZones, std::vector<unsigned int>& begin ) {
+    std::vector<float> x;
+    begin.clear();
+    for ( unsigned int zone = 0; nZones > zone; ++zone ) {
+      begin.push_back( x.size() );
+      const unsigned int nHits = rng() % 300;
+      const unsigned int first = x.size();
+      for ( unsigned int i = 0; nHits > i; ++i ) x.push_back( 0.25f * ( int( rng() % 800 ) - 400 ) );
+      std::sort( x.begin() + first, x.end() );
+    }
+    begin.push_back( x.size() );
+    return x;
+  }
+
+  /// Is the hit best the only one of the window at its distance?
+  bool tie( const std::vector<float>& x, unsigned int first, unsigned int end, float xPred, float xMax, int best ) {
+    if ( -1 == best ) return false;
+    const float dist = std::fabs( x[best] - xPred );
+    for ( unsigned int iH = first; end != iH && x[iH] <= xMax; ++iH ) {
+      if ( int( iH ) != best && std::fabs( x[iH] - xPred ) == dist ) return true;
+    }
+    return false;
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140702 );
+  std::vector<unsigned int> begin;
+  const std::vector<float> x = makeHits( rng, 24, begin );
+  const float halfWidths[4] = { 0.5, 1., 2.5, 12.5 };
+
+  int status = 0;
+  unsigned int nSearched = 0;
+  unsigned int nTies     = 0;
+  std::vector<unsigned int> nDiffer( PrSeedingSimd::AVX512 + 1, 0 );
+
+  for ( unsigned int iGroup = 0; 2000 > iGroup; ++iGroup ) {
+    const unsigned int zone = rng() % 24;
+    const unsigned int end  = begin[zone+1];
+    const unsigned int nHyp = 1 + rng() % 40;
+    const float centre    = 0.125f * ( int( rng() % 1600 ) - 800 );
+    const float halfWidth = halfWidths[rng() % 4];
+
+    std::vector<float> xPred( nHyp ), xMin( nHyp ), xMax( nHyp );
+    std::vector<unsigned int> first( nHyp );
+    std::vector<int> ref( nHyp );
+    for ( unsigned int h = 0; nHyp > h; ++h ) {
+      xPred[h] = centre + 0.125f * ( int( rng() % 81 ) - 40 );
+      xMin[h]  = xPred[h] - halfWidth;
+      xMax[h]  = xPred[h] + halfWidth;
+      first[h] = std::lower_bound( x.begin() + begin[zone], x.begin() + end, xMin[h] ) - x.begin();
+      ref[h]   = PrSeedingClosestHit::scan( x.data(), first[h], end, xPred[h], xMax[h], maxDist );
+      if ( tie( x, first[h], end, xPred[h], xMax[h], ref[h] ) ) ++nTies;
+    }
+    nSearched += nHyp;
+
+    for ( int l = PrSeedingSimd::SSE42; PrSeedingSimd::AVX512 >= l; ++l ) {
+      const PrSeedingSimd::Level level = PrSeedingSimd::Level( l );
+      if ( !PrSeedingSimd::supported( level ) ) continue;
+      std::vector<int> best( nHyp, -2 );
+      PrSeedingClosestHit::select( level )( x.data(), first.data(), end, nHyp,
+                                            xPred.data(), xMin.data(), xMax.data(), maxDist, best.data() );
+      if ( best != ref ) ++nDiffer[l];
+    }
+  }
+
+  std::printf( "%u predictions, %u with equally close hits\n", nSearched, nTies );
+  for ( int l = PrSeedingSimd::SSE42; PrSeedingSimd::AVX512 >= l; ++l ) {
+    const PrSeedingSimd::Level level = PrSeedingSimd::Level( l );
+    if ( !PrSeedingSimd::supported( level ) ) {
+      std::printf( "%-8s not supported by this CPU, skipped\n", PrSeedingSimd::name( level ) );
+      continue;
+    }
+    std::printf( "%-8s %u of 2000 groups differ from the scan\n", PrSeedingSimd::name( level ), nDiffer[l] );
+    if ( 0 != nDiffer[l] ) status = 1;
+  }
+  return status;
+}
@@ -0,0 +1,143 @@
+// Include files
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "PrSeedingSearch.h"
+#include "PrSeedingTestEvent.h"
+
+//-----------------------------------------------------------------------------
+// Test of the curvature table of PrSeedingSearch, with a field model in place of the
+// magnetic field service and PrGeometryTool::qOverP(): q/p proportional to x0, with a
+// polarity and a scale. As PrSeedingXLayers::updateCurvatureTable() does when the field
+// changes, the table is rebuilt from the model after each change of the field. Then:
+//
+// - at the centre of every bin, the lookup gives the direct formula of the curvature and
+//   its spread for the current field, bit for bit;
+// - at random points, the lookup gives the value of the centre of their bin, and of the
+//   closest bin outside the grid;
+// - the table does not change with the polarity, and scales with the field;
+// - the search with UseCurvatureTable finds other tracks with a much stronger field, and
+//   the same tracks again when the field comes back.
+//
+// Returns 0 on success, 1 if a lookup or search differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  /// Field model: q/p of the straight line ( tx, x0 ), 1e-4 / MeV at x0 = 3 m for the nominal field
+  struct Field {
+    float polarity;
+    float scale;
+
+    float qOverP( float /* tx */, float x0 ) const { return polarity * scale * x0 / 3e7f; }
+  };
+
+  /// Rebuild the table of the search for the field, as the update of the field does
+  void update( PrSeedingSearch& search, const Field& field ) {
+    search.buildCurvatureTable( [&field]( float tx, float x0 ) -> float { return field.qOverP( tx, x0 ); } );
+  }
+
+  /// Curvature and spread of the field at ( tx, x0 ), as the table is filled
+  void direct( const PrSeedingSearch& search, const Field& field, float tx, float x0, float& curvature, float& spread ) {
+    const PrSeedingSearch::Config& config = search.config();
+    curvature = std::fabs( config.curvaturePerQOverP * field.qOverP( tx, x0 ) );
+    spread    = config.curvatureSpread * curvature;
+  }
+
+  /// Centre of the bin of v, clamped to the grid of n bins over [-vMax, vMax]
+  float centre( float v, float vMax, unsigned int n ) {
+    const float scale = 0.5f * n / vMax;
+    const float b = ( v + vMax ) * scale;
+    const unsigned int i = !( b > 0. ) ? 0 : ( b < n ? static_cast<unsigned int>( b ) : n - 1 );
+    return ( i + 0.5f ) / scale - vMax;
+  }
+
+  /// Number of bins or points whose lookup differs from the direct formula for the field
+  unsigned int nWrong( const PrSeedingSearch& search, const Field& field ) {
+    const PrSeedingCurvatureTable& table = search.curvatureTable();
+    const unsigned int nTx = PrSeedingSearch::curvatureTableTxBins;
+    const unsigned int nX0 = PrSeedingSearch::curvatureTableX0Bins;
+    const float txMax = PrSeedingSearch::curvatureTableTxMax;
+    const float x0Max = search.config().maxIpAtZero;
+    unsigned int n = 0;
+    float curvature, spread, expected, expectedSpread;
+
+    for ( unsigned int iTx = 0; nTx > iTx; ++iTx ) {
+      const float tx = ( iTx + 0.5f ) / ( 0.5f * nTx / txMax ) - txMax;
+      for ( unsigned int iX0 = 0; nX0 > iX0; ++iX0 ) {
+        const float x0 = ( iX0 + 0.5f ) / ( 0.5f * nX0 / x0Max ) - x0Max;
+        table.lookup( tx, x0, curvature, spread );
+        direct( search, field, tx, x0, expected, expectedSpread );
+        if ( curvature != expected || spread != expectedSpread ) ++n;
+      }
+    }
+
+    // -- Random points, a quarter of them outside the grid
+    std::mt19937 rng( 20140212 );
+    for ( unsigned int k = 0; 10000 > k; ++k ) {
+      const float tx = PrSeedingTestEvent::uniform( rng, -1.25f * txMax, 1.25f * txMax );
+      const float x0 = PrSeedingTestEvent::uniform( rng, -1.25f * x0Max, 1.25f * x0Max );
+      table.lookup( tx, x0, curvature, spread );
+      direct( search, field, centre( tx, txMax, nTx ), centre( x0, x0Max, nX0 ), expected, expectedSpread );
+      if ( curvature != expected || spread != expectedSpread ) ++n;
+    }
+    return n;
+  }
+}
+
+int main() {
+  PrSeedingSearch::Config config;
+  config.useCurvatureTable = true;
+  PrSeedingSearch search;
+  search.configure( config, PrSeedingSimd::best() );
+  PrSeedingTestEvent::makeGeometry( search.geometry() );
+
+  unsigned int nFailed = 0;
+  const Field up       = { 1.f, 1.f };
+  const Field down     = { -1.f, 1.f };
+  const Field half     = { 1.f, 0.5f };
+  const Field stronger = { 1.f, 100.f };
+
+  // -- Lookups for each field, after its update
+  const Field* fields[3] = { &up, &down, &half };
+  const char* names[3]   = { "up", "down", "half" };
+  for ( unsigned int f = 0; 3 > f; ++f ) {
+    update( search, *fields[f] );
+    const unsigned int n = nWrong( search, *fields[f] );
+    std::printf( "field %-4s: %u lookups differ from the direct formula\n", names[f], n );
+    if ( 0 != n ) ++nFailed;
+  }
+
+  // -- The polarity does not change the table, the scale does
+  update( search, down );
+  if ( 0 != nWrong( search, up ) ) {
+    std::printf( "the table of polarity down differs from the one of polarity up\n" );
+    ++nFailed;
+  }
+  update( search, half );
+  if ( 0 == nWrong( search, up ) ) {
+    std::printf( "the table of the field at half scale is the one of the nominal field\n" );
+    ++nFailed;
+  }
+
+  // -- The search reads the table of the last update
+  PrSeedingHitStore hits;
+  hits.setBucketWidth( config.xBucketWidth );
+  PrSeedingSearch::EventContext context( search );
+  PrSeedingTestEvent::fill( hits, search.geometry(), 20140301, 200, 30 );
+  update( search, up );
+  const PrSeedingTestEvent::Tracks nominal = PrSeedingTestEvent::search( search, hits, context );
+  update( search, stronger );
+  const PrSeedingTestEvent::Tracks strong = PrSeedingTestEvent::search( search, hits, context );
+  update( search, up );
+  const PrSeedingTestEvent::Tracks again = PrSeedingTestEvent::search( search, hits, context );
+  const unsigned int nChanged = PrSeedingTestEvent::nDifferent( nominal, strong );
+  const unsigned int nAgain   = PrSeedingTestEvent::nDifferent( nominal, again );
+  std::printf( "search: %u tracks with the nominal field, %u with a 100 times stronger one, "
+               "%u differ when the nominal field is back\n",
+               (unsigned int)nominal.size(), (unsigned int)strong.size(), nAgain );
+  if ( 0 == nChanged || 0 != nAgain ) ++nFailed;
+
+  return 0 == nFailed ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// Include files
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "PrSeedingDoublets.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingDoublets against the loop over the pairs of hits of the first and last
+// zones of a case which findXProjections2 had before: for each first hit which is not used,
+// the last hits which are not used from the lower bound of the MaxIpAtZero window, up to its
+// upper bound excluded, and the line through them. On random hits, with hits exactly on the
+// bounds of the windows, with and without used hits, several grid widths, and one set of
+// doublets built again for each event:
+//
+// - a group for each first hit which is not used, in the order of the hits, also without pairs;
+// - the last hits of each group in the order of the hits, and the slope and x at z = 0 of
+//   their lines bit for bit.
+//
+// Returns 0 on success, 1 if a doublet differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const float zFirst      = 7855.f;
+  const float zLast       = 9410.f;
+  const float maxIpAtZero = 5000.f;
+
+  /// A doublet of the loop over the pairs
+  struct Pair {
+    unsigned int first;
+    unsigned int last;
+    float        tx;
+    float        x0;
+  };
+
+  /// Three zones, the middle one between the first and the last one so that their hits do not start at 0.
+  /// Some of the last hits are on the bounds of the windows of first hits
+  void fill( PrSeedingHitStore& store, std::mt19937& rng, unsigned int nFirst, unsigned int nLast ) {
+    std::uniform_real_distribution<float> uniform( -3000.f, 3000.f );
+    std::vector<float> xFirst, xLast;
+    for ( unsigned int k = 0; nFirst > k; ++k ) xFirst.push_back( uniform( rng ) );
+    for ( unsigned int k = 0; nLast > k; ++k ) xLast.push_back( 1.2f * uniform( rng ) );
+    for ( unsigned int k = 0; nFirst > k && 0 < nLast; k += 5 ) {
+      float minXl, maxXl;
+      PrSeedingDoublets::lastWindow( xFirst[k], zFirst, zLast, maxIpAtZero, minXl, maxXl );
+      xLast[rng() % nLast] = ( 0 == k % 2 ) ? minXl : maxXl;
+    }
+    std::sort( xFirst.begin(), xFirst.end() );
+    std::sort( xLast.begin(), xLast.end() );
+
+    store.clear( 3, nFirst + nLast + 10 );
+    unsigned int id = 0;
+    store.addZone( 0.f, 0.f );
+    for ( unsigned int k = 0; nFirst > k; ++k ) store.addHit( xFirst[k], zFirst, 1.f, ++id, 0, nullptr );
+    store.addZone( 0.f, 0.f );
+    for ( unsigned int k = 0; 10 > k; ++k ) store.addHit( -2500.f + 500.f * k, 8500.f, 1.f, ++id, 4, nullptr );
+    store.addZone( 0.f, 0.f );
+    for ( unsigned int k = 0; nLast > k; ++k ) store.addHit( xLast[k], zLast, 1.f, ++id, 8, nullptr );
+    store.close();
+  }
+
+  /// The loop of findXProjections2 over the pairs of the first and last zones
+  void loopOverPairs( const PrSeedingHitStore& store, const PrSeedingUsedHits* used, std::vector<unsigned int>& groups,
+                      std::vector<Pair>& pairs ) {
+    groups.clear();
+    pairs.clear();
+    const float zRatio = zLast / zFirst;
+    for ( unsigned int iF = store.begin( 0 ); store.end( 0 ) != iF; ++iF ) {
+      if ( used && used->isUsed( iF ) ) continue;
+      groups.push_back( iF );
+      const float xF = store.x( iF );
+      const float minXl = xF * zRatio - maxIpAtZero * ( zRatio - 1 );
+      const float maxXl = xF * zRatio + maxIpAtZero * ( zRatio - 1 );
+      for ( unsigned int iL = store.begin( 2 ); store.end( 2 ) != iL; ++iL ) {
+        if ( store.x( iL ) < minXl || !( store.x( iL ) < maxXl ) ) continue;
+        if ( used && used->isUsed( iL ) ) continue;
+        const float tx = ( store.x( iL ) - xF ) / ( zLast - zFirst );
+        const Pair pair = { iF, iL, tx, xF - store.z( iF ) * tx };
+        pairs.push_back( pair );
+      }
+    }
+  }
+
+  /// Number of groups and pairs which differ from the loop over the pairs
+  unsigned int nDifferent( const PrSeedingDoublets& doublets, const std::vector<unsigned int>& groups,
+                           const std::vector<Pair>& pairs ) {
+    if ( doublets.nGroups() != groups.size() ) return 1 + groups.size();
+    unsigned int n = 0;
+    unsigned int k = 0;
+    for ( unsigned int g = 0; groups.size() > g; ++g ) {
+      if ( doublets.firstHit( g ) != groups[g] || doublets.begin( g ) != k ) ++n;
+      for ( ; pairs.size() > k && groups[g] == pairs[k].first; ++k ) {
+        if ( doublets.end( g ) <= k ) continue;
+        if ( doublets.lastHit( k ) != pairs[k].last || doublets.tx( k ) != pairs[k].tx || doublets.x0( k ) != pairs[k].x0 ) ++n;
+      }
+      if ( doublets.end( g ) != k ) ++n;
+    }
+    return n;
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140725 );
+  PrSeedingArena arena;
+  PrSeedingDoublets doublets( ( PrHitIndices::allocator_type( &arena ) ) );
+  PrSeedingHitStore store;
+  PrSeedingUsedHits used;
+  std::vector<unsigned int> groups;
+  std::vector<Pair> pairs;
+
+  unsigned int nFailed = 0;
+  unsigned int nPairs  = 0;
+  const unsigned int nFirst[6] = { 300, 0, 50, 1000, 200, 20 };
+  const unsigned int nLast[6]  = { 300, 100, 0, 1200, 5, 400 };
+  const float widths[3]        = { 1.f, 4.f, 100.f };
+  for ( unsigned int e = 0; 6 > e; ++e ) {
+    for ( unsigned int iW = 0; 3 > iW; ++iW ) {
+      store.setBucketWidth( widths[iW] );
+      fill( store, rng, nFirst[e], nLast[e] );
+
+      // -- All the hits, then a third of them used
+      used.reset( store.size() );
+      for ( unsigned int u = 0; 2 > u; ++u ) {
+        const PrSeedingUsedHits* flags = ( 0 == u ) ? nullptr : &used;
+        if ( 1 == u ) {
+          for ( unsigned int hit = 0; store.size() > hit; ++hit ) {
+            if ( 0 == rng() % 3 ) used.setUsed( hit );
+          }
+        }
+        doublets.build( store, flags, 0, 2, zFirst, zLast, maxIpAtZero );
+        loopOverPairs( store, flags, groups, pairs );
+        nPairs += pairs.size();
+        const unsigned int n = nDifferent( doublets, groups, pairs );
+        if ( 0 != n ) {
+          std::printf( "event %u, grid width %g, %s used hits: %u differences in %u groups and %u pairs\n", e, widths[iW],
+                       flags ? "with" : "without", n, (unsigned int)groups.size(), (unsigned int)pairs.size() );
+          ++nFailed;
+        }
+      }
+    }
+  }
+  std::printf( "%u pairs: %u events differ from the loop over the pairs\n", nPairs, nFailed );
+  return 0 == nFailed ? 0 : 1;
+}
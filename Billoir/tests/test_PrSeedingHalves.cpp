@@ -0,0 +1,67 @@
+// Include files
+#include <cstdio>
+#include <vector>
+
+#include "tbb/global_control.h"
+
+#include "PrSeedingSearch.h"
+#include "PrSeedingTestEvent.h"
+
+//-----------------------------------------------------------------------------
+// Test of ConcurrentHalves: fixed synthetic events are searched with the two halves
+// one after the other, then several times with the two halves as concurrent tasks.
+// The halves only read and set the used flags of their own hits, so every run must
+// give the tracks of the serial search, track by track, hit for hit and bit for bit.
+// TBB is allowed more threads than the machine has cores, so that the halves also run
+// at the same time on a single core.
+//
+// Returns 0 on success, 1 if a track differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const unsigned int nEvents  = 8;
+  const unsigned int nRepeats = 5;
+
+  unsigned int seedOf( unsigned int event ) { return 20140212 + event; }
+  unsigned int tracksOf( unsigned int event ) { return 50 + 50 * event; }
+}
+
+int main() {
+  tbb::global_control threads( tbb::global_control::max_allowed_parallelism, 4 );
+
+  PrSeedingSearch serial;
+  serial.configure( PrSeedingSearch::Config(), PrSeedingSimd::best() );
+  PrSeedingTestEvent::makeGeometry( serial.geometry() );
+
+  PrSeedingSearch::Config config;
+  config.concurrentHalves = true;
+  PrSeedingSearch concurrent;
+  concurrent.configure( config, PrSeedingSimd::best() );
+  PrSeedingTestEvent::makeGeometry( concurrent.geometry() );
+
+  PrSeedingHitStore hits;
+  hits.setBucketWidth( config.xBucketWidth );
+  PrSeedingSearch::EventContext serialContext( serial );
+  PrSeedingSearch::EventContext concurrentContext( concurrent );
+
+  unsigned int nFailed = 0;
+  unsigned int nTracks = 0;
+  for ( unsigned int e = 0; nEvents > e; ++e ) {
+    PrSeedingTestEvent::fill( hits, serial.geometry(), seedOf( e ), tracksOf( e ), 30 );
+    const PrSeedingTestEvent::Tracks reference = PrSeedingTestEvent::search( serial, hits, serialContext );
+    nTracks += reference.size();
+    for ( unsigned int r = 0; nRepeats > r; ++r ) {
+      const PrSeedingTestEvent::Tracks tracks = PrSeedingTestEvent::search( concurrent, hits, concurrentContext );
+      const unsigned int n = PrSeedingTestEvent::nDifferent( reference, tracks );
+      if ( 0 != n ) {
+        std::printf( "event %u, run %u: %u of %u tracks differ from the serial search, the first one is track %u\n",
+                     e, r, n, (unsigned int)reference.size(), PrSeedingTestEvent::firstDifferent( reference, tracks ) );
+        ++nFailed;
+      }
+    }
+  }
+  std::printf( "%u events, %u tracks: %u of %u concurrent runs differ from the serial search\n",
+               nEvents, nTracks, nFailed, nEvents * nRepeats );
+  return 0 == nFailed ? 0 : 1;
+}
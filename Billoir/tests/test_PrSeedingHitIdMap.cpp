@@ -0,0 +1,73 @@
+// Include files
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "PrSeedingHitIdMap.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingHitIdMap: for several events of hits with random and with
+// consecutive ids, some of them shared by two hits, forEach() must give the hits of
+// an id as a std::multimap does, and nothing for the ids which are not in the map.
+// The map is reused from one event to the next, as in the hit store.
+//
+// Returns 0 on success, 1 if an event differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  /// The hits of id, sorted
+  std::vector<unsigned int> hitsOf( const PrSeedingHitIdMap& map, unsigned int id ) {
+    std::vector<unsigned int> hits;
+    map.forEach( id, [&hits]( unsigned int hit ) { hits.push_back( hit ); } );
+    std::sort( hits.begin(), hits.end() );
+    return hits;
+  }
+
+  std::vector<unsigned int> hitsOf( const std::multimap<unsigned int, unsigned int>& ref, unsigned int id ) {
+    std::vector<unsigned int> hits;
+    for ( std::multimap<unsigned int, unsigned int>::const_iterator it = ref.lower_bound( id );
+          ref.end() != it && id == (*it).first; ++it ) hits.push_back( (*it).second );
+    std::sort( hits.begin(), hits.end() );
+    return hits;
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140630 );
+  PrSeedingHitIdMap map;
+
+  // -- A map never filled has no hits
+  unsigned int nDiffer = hitsOf( map, 12345 ).empty() ? 0 : 1;
+
+  const unsigned int nHitsOfEvent[6] = { 0, 1, 17, 1000, 9000, 300 };
+  for ( unsigned int iEvent = 0; 6 > iEvent; ++iEvent ) {
+    const unsigned int nHits = nHitsOfEvent[iEvent];
+    std::multimap<unsigned int, unsigned int> ref;
+    std::vector<unsigned int> ids;
+    map.clear( nHits );
+    // -- Odd events have consecutive ids from a random start, as the channels of a module
+    const unsigned int start = rng();
+    for ( unsigned int hit = 0; nHits > hit; ++hit ) {
+      unsigned int id = ( 1 == iEvent % 2 ) ? start + hit : (unsigned int)rng();
+      if ( 0 != hit && 0 == rng() % 10 ) id = ids[rng() % ids.size()];  // a second hit with the same id
+      ids.push_back( id );
+      map.insert( id, hit );
+      ref.insert( std::make_pair( id, hit ) );
+    }
+
+    unsigned int nWrong = 0;
+    for ( std::vector<unsigned int>::const_iterator itId = ids.begin(); ids.end() != itId; ++itId ) {
+      if ( hitsOf( map, *itId ) != hitsOf( ref, *itId ) ) ++nWrong;
+    }
+    for ( unsigned int k = 0; 1000 > k; ++k ) {
+      const unsigned int id = ( 0 == k % 2 ) ? (unsigned int)rng() : start + nHits + k;
+      if ( hitsOf( map, id ) != hitsOf( ref, id ) ) ++nWrong;
+    }
+    std::printf( "%5u hits: %u lookups differ from std::multimap\n", nHits, nWrong );
+    if ( 0 != nWrong ) ++nDiffer;
+  }
+  return 0 == nDiffer ? 0 : 1;
+}
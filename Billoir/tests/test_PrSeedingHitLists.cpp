@@ -0,0 +1,99 @@
+// Include files
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "PrSeedingHitLists.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingHitLists against the lists of the parabola hypotheses of a doublet
+// as they were kept before: a vector of lists, each new one compared to all the others,
+// then a stable sort of the lists. For rounds of lists drawn from a few hits, so that many
+// are the same, with clear() between the rounds as between the doublets:
+//
+// - insert() adds a list only if it is not in the set yet, whatever its fingerprint;
+// - the lists are kept in the insertion order, then in the order of the stable sort, and
+//   inserted() gives the position of each one in the insertion order;
+// - the fingerprint is the same for the same hits, and differs for the same hits in
+//   another order and for a list and its prefix.
+//
+// Returns 0 on success, 1 if a list differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  typedef std::vector<unsigned int> List;
+
+  unsigned int nFailed = 0;
+
+  void check( bool ok, const char* what ) {
+    if ( ok ) return;
+    std::printf( "FAILED: %s\n", what );
+    ++nFailed;
+  }
+
+  /// The lists of the set are the expected ones, in the same order
+  bool same( const PrSeedingHitLists& lists, const std::vector<List>& expected ) {
+    if ( lists.size() != expected.size() ) return false;
+    for ( unsigned int k = 0; expected.size() > k; ++k ) {
+      if ( lists.end( k ) - lists.begin( k ) != (long)expected[k].size() ) return false;
+      if ( !std::equal( expected[k].begin(), expected[k].end(), lists.begin( k ) ) ) return false;
+    }
+    return true;
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140720 );
+  PrSeedingArena arena;
+  PrSeedingHitLists lists( ( PrHitIndices::allocator_type( &arena ) ) );
+  lists.reserve( 4, 40 );
+
+  unsigned int nInserted = 0;
+  unsigned int nLists    = 0;
+  const unsigned int nRounds = 200;
+  for ( unsigned int r = 0; nRounds > r; ++r ) {
+    lists.clear();
+    std::vector<List> expected;
+
+    // -- A few hits, and lists of up to 4 of them, also empty ones
+    const unsigned int nHits = 2 + rng() % 3;
+    const unsigned int nTries = rng() % 40;
+    for ( unsigned int t = 0; nTries > t; ++t ) {
+      List list;
+      for ( unsigned int k = rng() % 5; 0 < k; --k ) list.push_back( 1000 * r + rng() % nHits );
+      const bool isNew = std::find( expected.begin(), expected.end(), list ) == expected.end();
+      if ( isNew ) expected.push_back( list );
+      if ( isNew != lists.insert( list.begin(), list.end() ) ) {
+        std::printf( "round %u: list %u is %s, the set says otherwise\n", r, t, isNew ? "new" : "a duplicate" );
+        ++nFailed;
+      }
+    }
+    nInserted += nTries;
+    nLists += expected.size();
+    check( same( lists, expected ), "the lists are the inserted ones, in the insertion order" );
+    for ( unsigned int k = 0; lists.size() > k; ++k ) check( k == lists.inserted( k ), "inserted() before the sort" );
+
+    // -- Lexicographic order, the equal lists were already removed
+    std::vector<List> sorted( expected );
+    std::stable_sort( sorted.begin(), sorted.end() );
+    lists.sort( arena );
+    check( same( lists, sorted ), "the lists are in the order of the stable sort" );
+    for ( unsigned int k = 0; lists.size() > k; ++k ) {
+      check( expected[lists.inserted( k )] == sorted[k], "inserted() gives the position of the list before the sort" );
+    }
+  }
+  std::printf( "%u rounds, %u lists inserted, %u distinct\n", nRounds, nInserted, nLists );
+
+  // -- Fingerprints
+  const unsigned int a[3] = { 3, 17, 42 };
+  const unsigned int b[3] = { 3, 17, 42 };
+  const unsigned int c[3] = { 17, 3, 42 };
+  check( PrSeedingHitLists::fingerprint( a, a + 3 ) == PrSeedingHitLists::fingerprint( b, b + 3 ), "same hits, same fingerprint" );
+  check( PrSeedingHitLists::fingerprint( a, a + 3 ) != PrSeedingHitLists::fingerprint( c, c + 3 ), "another order, another fingerprint" );
+  check( PrSeedingHitLists::fingerprint( a, a + 3 ) != PrSeedingHitLists::fingerprint( a, a + 2 ), "a prefix, another fingerprint" );
+
+  std::printf( "%u checks failed\n", nFailed );
+  return 0 == nFailed ? 0 : 1;
+}
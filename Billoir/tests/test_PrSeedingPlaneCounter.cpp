@@ -0,0 +1,69 @@
+// Include files
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "PrSeedingPlaneCounter.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingPlaneCounter: nbDifferent() must be the number of planes counted
+// hit by hit, for windows sliding over the stereo hits as in PrSeedingXLayers, growing
+// and shrinking at the end, jumping forward past the previous one or back before it,
+// as when the x projections take turns with one counter, and for empty windows.
+//
+// Returns 0 on success, 1 if a window differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  /// Number of planes of the hits in [itBeg, itEnd), counted hit by hit
+  unsigned int nbPlanes( PrSeedingStereoHits::const_iterator itBeg, PrSeedingStereoHits::const_iterator itEnd ) {
+    bool seen[12] = {};
+    unsigned int n = 0;
+    for ( ; itEnd != itBeg; ++itBeg ) {
+      if ( !seen[(*itBeg).planeCode] ) ++n;
+      seen[(*itBeg).planeCode] = true;
+    }
+    return n;
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140707 );
+  const unsigned int nHits = 2000;
+
+  // -- The hits of a projection are often on a few planes only
+  PrSeedingStereoHits hits;
+  for ( unsigned int i = 0; nHits > i; ++i ) {
+    const unsigned int planeCode = ( 0 == ( i / 100 ) % 3 ) ? 2 * ( rng() % 3 ) : rng() % 12;
+    hits.push_back( PrSeedingStereoHit( 0.001f * i, i, planeCode ) );
+  }
+
+  PrSeedingPlaneCounter plCount;
+  unsigned int nWindows = 0;
+  unsigned int nWrong   = 0;
+  unsigned int beg = 0;
+  unsigned int end = 0;
+  for ( unsigned int k = 0; 200000 > k; ++k ) {
+    switch ( rng() % 8 ) {
+    case 0: beg = rng() % nHits; end = beg + rng() % 30; break;         // anywhere, also before the last window
+    case 1: beg = end + rng() % 5; end = beg + rng() % 30; break;       // just after the last window
+    case 2: end = beg + rng() % 30; break;                              // the same start, another end
+    case 3: end = beg; break;                                           // empty
+    default: ++beg; end = std::max( end, beg + 5 ) + rng() % 3; break;  // sliding, as the search
+    }
+    if ( nHits < end ) end = nHits;
+    if ( end < beg ) beg = end;
+    plCount.set( hits.begin() + beg, hits.begin() + end );
+    if ( plCount.nbDifferent() != nbPlanes( hits.begin() + beg, hits.begin() + end ) ) ++nWrong;
+    ++nWindows;
+  }
+
+  // -- The static helpers on masks of planes
+  unsigned int mask = 0;
+  for ( unsigned int planeCode = 0; 12 > planeCode; planeCode += 3 ) mask |= PrSeedingPlaneCounter::planeBit( planeCode );
+  if ( 4 != PrSeedingPlaneCounter::nbPlanes( mask ) ) ++nWrong;
+
+  std::printf( "%u of %u windows differ from the count hit by hit\n", nWrong, nWindows );
+  return 0 == nWrong ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+// Include files
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "PrSeedingPool.h"
+#include "PrSeedingSearch.h"
+#include "PrSeedingTestEvent.h"
+
+//-----------------------------------------------------------------------------
+// Test of the re-entrancy of PrSeedingSearch: synthetic events are searched one after
+// the other in a single context, then by several threads at once, each event with the
+// hits and context it takes from a PrSeedingPool, as PrSeedingXLayers does. Every event
+// must give the same tracks, hit for hit and bit for bit, and the pool must have made no
+// more contexts than there were threads.
+//
+// Returns 0 on success, 1 if an event differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const unsigned int nEvents  = 24;
+  const unsigned int nThreads = 4;
+
+  struct EventData {
+    explicit EventData( const PrSeedingSearch& search ) : context( search ) {
+      hits.setBucketWidth( search.config().xBucketWidth );
+    }
+
+    PrSeedingHitStore             hits;
+    PrSeedingSearch::EventContext context;
+  };
+
+  unsigned int seedOf( unsigned int event ) { return 20150301 + event; }
+  unsigned int tracksOf( unsigned int event ) { return 40 + 20 * ( event % 5 ); }
+}
+
+int main() {
+  PrSeedingSearch search;
+  search.configure( PrSeedingSearch::Config(), PrSeedingSimd::best() );
+  PrSeedingTestEvent::makeGeometry( search.geometry() );
+
+  // -- Reference: one event at a time, in the same context
+  std::vector<PrSeedingTestEvent::Tracks> reference( nEvents );
+  {
+    EventData event( search );
+    unsigned int nTracks = 0;
+    for ( unsigned int e = 0; nEvents > e; ++e ) {
+      PrSeedingTestEvent::fill( event.hits, search.geometry(), seedOf( e ), tracksOf( e ), 30 );
+      reference[e] = PrSeedingTestEvent::search( search, event.hits, event.context );
+      nTracks += reference[e].size();
+    }
+    std::printf( "%u events, %u tracks found one event at a time\n", nEvents, nTracks );
+  }
+
+  // -- The same events on concurrent threads, each taking its hits and context from the pool
+  PrSeedingPool<EventData> pool;
+  pool.reset( [&search]() { return new EventData( search ); } );
+  std::vector<PrSeedingTestEvent::Tracks> concurrent( nEvents );
+  std::atomic<unsigned int> next( 0 );
+  std::vector<std::thread> threads;
+  for ( unsigned int t = 0; nThreads > t; ++t ) {
+    threads.emplace_back( [&]() {
+      for ( unsigned int e = next++; nEvents > e; e = next++ ) {
+        PrSeedingPool<EventData>::Lease event = pool.acquire();
+        PrSeedingTestEvent::fill( event->hits, search.geometry(), seedOf( e ), tracksOf( e ), 30 );
+        concurrent[e] = PrSeedingTestEvent::search( search, event->hits, event->context );
+      }
+    } );
+  }
+  for ( unsigned int t = 0; nThreads > t; ++t ) threads[t].join();
+
+  unsigned int nFailed = 0;
+  for ( unsigned int e = 0; nEvents > e; ++e ) {
+    const unsigned int n = PrSeedingTestEvent::nDifferent( reference[e], concurrent[e] );
+    if ( 0 != n ) {
+      std::printf( "event %2u: %u tracks differ from the ones found one event at a time\n", e, n );
+      ++nFailed;
+    }
+  }
+  std::printf( "%u threads: %u events differ, %u contexts made\n", nThreads, nFailed, pool.nFree() );
+  if ( 0 == pool.nFree() || nThreads < pool.nFree() ) ++nFailed;
+  return 0 == nFailed ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+// Include files
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "PrSeedingSort.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingSort::radixSortByKey: the order must be the one of std::stable_sort
+// with key( lhs ) < key( rhs ), for ranges around radixSortLimit and well above it, also
+// with the radix sort forced below it, and for keys which are all different, mostly
+// equal, negative, -0 and +0 mixed, denormal or infinite. The elements are sorted as the stereo hits are, by a member, and as the
+// parabola seed hits are, by a key computed from a hit index.
+//
+// Returns 0 on success, 1 if an order differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  struct Item {
+    float        key;
+    unsigned int id;
+  };
+
+  enum Keys { Random, FewValues, Negative, SignedZeros, Extremes, nKeys };
+  const char* const keysName[nKeys] = { "random", "few values", "negative", "-0 and +0", "extremes" };
+
+  float makeKey( std::mt19937& rng, Keys keys ) {
+    std::uniform_real_distribution<float> flat( -1000., 1000. );
+    switch ( keys ) {
+    case Random:      return flat( rng );
+    case FewValues:   return 0.5f * int( rng() % 7 ) - 1.5f;
+    case Negative:    return -std::fabs( flat( rng ) );
+    case SignedZeros: return ( 0 == rng() % 3 ) ? 1.f : ( 0 == rng() % 2 ? -0.f : 0.f );
+    default: {
+      const float extremes[8] = { std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                                  std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::denorm_min(),
+                                  std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+                                  std::numeric_limits<float>::min(), -0.f };
+      return ( 0 == rng() % 2 ) ? extremes[rng() % 8] : flat( rng );
+    }
+    }
+  }
+
+  bool sameOrder( const std::vector<Item>& lhs, const std::vector<Item>& rhs ) {
+    for ( unsigned int i = 0; lhs.size() > i; ++i ) {
+      if ( lhs[i].id != rhs[i].id ) return false;
+    }
+    return lhs.size() == rhs.size();
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140705 );
+  PrSeedingArena arena;
+  unsigned int nDiffer = 0;
+
+  const unsigned int nSizes = 9;
+  const unsigned int sizes[nSizes] = { 0, 1, 17, 256, 1000, 1999, 2000, 2001, 20000 };
+  for ( unsigned int iK = 0; nKeys > iK; ++iK ) {
+    unsigned int nWrong = 0;
+    for ( unsigned int iS = 0; nSizes > iS; ++iS ) {
+      std::vector<Item> items( sizes[iS] );
+      for ( unsigned int i = 0; sizes[iS] > i; ++i ) {
+        items[i].key = makeKey( rng, Keys( iK ) );
+        items[i].id  = i;
+      }
+
+      // -- By a member, as the stereo hits
+      std::vector<Item> ref( items );
+      std::stable_sort( ref.begin(), ref.end(), []( const Item& lhs, const Item& rhs ) { return lhs.key < rhs.key; } );
+      std::vector<Item> sorted( items );
+      PrSeedingSort::radixSortByKey( sorted.begin(), sorted.end(), []( const Item& item ) -> float { return item.key; }, arena );
+      if ( !sameOrder( sorted, ref ) ) ++nWrong;
+
+      // -- The same with the radix sort at all sizes, as in bench_PrSeedingSort
+      sorted = items;
+      PrSeedingSort::radixSortByKey( sorted.begin(), sorted.end(), []( const Item& item ) -> float { return item.key; }, arena, 0 );
+      if ( !sameOrder( sorted, ref ) ) ++nWrong;
+
+      // -- By a key of the index, as the parabola seed hits
+      const Item* data = items.data();
+      std::vector<unsigned int> refIdx( sizes[iS] ), idx( sizes[iS] );
+      for ( unsigned int i = 0; sizes[iS] > i; ++i ) refIdx[i] = idx[i] = i;
+      auto key = [data]( unsigned int i ) -> float { return std::fabs( data[i].key ); };
+      std::stable_sort( refIdx.begin(), refIdx.end(), [&key]( unsigned int lhs, unsigned int rhs ) { return key( lhs ) < key( rhs ); } );
+      PrSeedingSort::radixSortByKey( idx.begin(), idx.end(), key, arena );
+      if ( idx != refIdx ) ++nWrong;
+      arena.reset();
+    }
+    std::printf( "%-10s keys: %u of %u orders differ from std::stable_sort\n", keysName[iK], nWrong, 3 * nSizes );
+    if ( 0 != nWrong ) ++nDiffer;
+  }
+  return 0 == nDiffer ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+// Include files
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "PrSeedingPlaneCounter.h"
+#include "PrSeedingSearch.h"
+#include "PrSeedingStereoHit.h"
+#include "PrSeedingTestEvent.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingSearch::addStereoToProjections, which slides the stereo windows of
+// all x projections together, fits the windows of a round in one batch and keeps a running
+// best per projection. The baseline is the stereo search of the seeding before: one x
+// projection at a time, each window fitted alone, all the candidates kept, then the best
+// one chosen by the pairwise loop. Both remove the hits of a failed fit with the same
+// downdated moments. On fixed synthetic events they must give the same tracks, bit for
+// bit and in the same order. The time of both is printed, it is not checked.
+//
+// Returns 0 on success, 1 if a track differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  const unsigned int nEvents = 8;
+  const unsigned int nRepeat = 5;
+
+  unsigned int seedOf( unsigned int event ) { return 20140214 + event; }
+  unsigned int tracksOf( unsigned int event ) { return 50 + 50 * event; }
+
+  /// setChi2 of the search
+  PRSEEDING_NO_CONTRACT
+  void setChi2( const PrSeedingHitStore& hits, PrSeedCandidate& track ) {
+    float chi2 = 0.;
+    int   nDoF = -3;
+    bool hasStereo = false;
+    for ( PrHitIndices::const_iterator itH = track.hits().begin(); track.hits().end() != itH; ++itH ) {
+      float d = track.distance( hits, *itH );
+      if ( hits.dxDy( *itH ) != 0 ) hasStereo = true;
+      float w = hits.w( *itH );
+      chi2 += w * d * d;
+      nDoF += 1;
+    }
+    if ( hasStereo ) nDoF -= 2;
+    track.setChi2( chi2, nDoF );
+  }
+
+  /// The stereo search of the seeding before the batches, for the valid x projections of a half
+  PRSEEDING_NO_CONTRACT
+  void addStereoBaseline( const PrSeedingSearch& search, const PrSeedingHitStore& hits, unsigned int part,
+                          const PrSeedCandidates& xCandidates, PrSeedCandidates& result ) {
+    const PrSeedingGeometry& geometry = search.geometry();
+    const PrSeedingSearch::Config& config = search.config();
+    const float zRef = geometry.zRef();
+    PrSeedingArena arena;
+    PrSeedCandidates candidates;
+
+    for ( PrSeedCandidates::const_iterator itT = xCandidates.begin(); xCandidates.end() != itT; ++itT ) {
+      if ( !(*itT).valid() ) continue;
+
+      arena.reset();
+      PrSeedingStereoHits myStereo( ( PrSeedingArena::Allocator<PrSeedingStereoHit>( &arena ) ) );
+      const PrSeedingGeometry::Zones& zones = geometry.stereoZones( part );
+      for ( PrSeedingGeometry::Zones::const_iterator itZ = zones.begin(); zones.end() != itZ; ++itZ ) {
+        const float dxDy   = geometry.dxDy( *itZ );
+        const float zPlane = geometry.z( *itZ );
+        const float xPred  = (*itT).x( zPlane );
+        const float xMin   = std::min( xPred + 2500.f * dxDy, xPred - 2500.f * dxDy );
+        const float xMax   = std::max( xPred + 2500.f * dxDy, xPred - 2500.f * dxDy );
+        for ( unsigned int iH = hits.lowerBoundX( *itZ, xMin ); hits.end( *itZ ) != iH; ++iH ) {
+          if ( hits.x( iH ) > xMax ) break;
+          const float coord = ( hits.x( iH ) - xPred ) / dxDy / zPlane;
+          if ( 1 == part && coord < -0.005 ) continue;
+          if ( 0 == part && coord > 0.005 ) continue;
+          myStereo.push_back( PrSeedingStereoHit( coord, iH, hits.planeCode( iH ) ) );
+        }
+      }
+      std::stable_sort( myStereo.begin(), myStereo.end(), PrSeedingStereoHit::LowerByCoord() );
+
+      PrSeedingPlaneCounter plCount;
+      candidates.clear();
+      PrSeedingStereoHits::const_iterator itBeg = myStereo.begin();
+      while ( myStereo.end() > itBeg + 5 ) {
+        PrSeedingStereoHits::const_iterator itEnd = itBeg + 5;
+        const float tolTy = config.tolTyOffset + config.tolTySlope * std::fabs( (*itBeg).coord );
+        if ( (*(itEnd-1)).coord - (*itBeg).coord < tolTy ) {
+          while ( itEnd + 1 < myStereo.end() && (*itEnd).coord - (*itBeg).coord < tolTy ) ++itEnd;
+          plCount.set( itBeg, itEnd );
+          if ( 4 < plCount.nbDifferent() ) {
+            PrSeedCandidate temp( *itT );
+            for ( PrSeedingStereoHits::const_iterator itH = itBeg; itEnd != itH; ++itH ) temp.addHit( (*itH).hit );
+            unsigned int worst = 0;
+            bool ok = PrSeedingBatchFit::fitTrack( hits, zRef, config.maxChi2InTrack, temp, worst );
+            ok = PrSeedingBatchFit::fitTrack( hits, zRef, config.maxChi2InTrack, temp, worst );
+            ok = PrSeedingBatchFit::fitTrack( hits, zRef, config.maxChi2InTrack, temp, worst );
+            if ( !ok && temp.hits().size() > 10 ) {
+              PrSeedingBatchFit::Moments moments( hits, zRef, temp );
+              while ( !ok && temp.hits().size() > 10 ) {
+                moments.remove( hits, zRef, temp.hits()[worst] );
+                temp.hits().erase( temp.hits().begin() + worst );
+                ok = PrSeedingBatchFit::fitTrack( hits, zRef, config.maxChi2InTrack, temp, moments, worst );
+              }
+            }
+            if ( ok ) {
+              setChi2( hits, temp );
+              const float maxChi2 = config.maxChi2PerDoF + 6 * temp.xSlope( 9000 ) * temp.xSlope( 9000 );
+              if ( temp.hits().size() > 9 || temp.chi2PerDoF() < maxChi2 ) candidates.push_back( temp );
+              itBeg += 4;
+            }
+          }
+        }
+        ++itBeg;
+      }
+
+      // -- Keep the best for this input track
+      for ( unsigned int kk = 0; candidates.size() > kk + 1; ++kk ) {
+        if ( !candidates[kk].valid() ) continue;
+        for ( unsigned int ll = kk + 1; candidates.size() > ll; ++ll ) {
+          if ( !candidates[ll].valid() ) continue;
+          if ( candidates[ll].hits().size() < candidates[kk].hits().size() ) {
+            candidates[ll].setValid( false );
+          } else if ( candidates[ll].hits().size() > candidates[kk].hits().size() ) {
+            candidates[kk].setValid( false );
+          } else if ( candidates[kk].chi2() < candidates[ll].chi2() ) {
+            candidates[ll].setValid( false );
+          } else {
+            candidates[kk].setValid( false );
+          }
+        }
+      }
+      for ( PrSeedCandidates::const_iterator itC = candidates.begin(); candidates.end() != itC; ++itC ) {
+        if ( (*itC).valid() ) result.push_back( *itC );
+      }
+    }
+  }
+}
+
+int main() {
+  PrSeedingSearch::Config config;
+  config.xOnly = true;
+  PrSeedingSearch search;
+  search.configure( config, PrSeedingSimd::best() );
+  PrSeedingTestEvent::makeGeometry( search.geometry() );
+
+  PrSeedingHitStore hits;
+  hits.setBucketWidth( config.xBucketWidth );
+  PrSeedingSearch::EventContext context( search );
+  PrSeedingSearch::SearchState state;
+  state.batchFit.setLevel( search.simdLevel() );
+
+  unsigned int nFailed       = 0;
+  unsigned int nTracks       = 0;
+  unsigned int nXProjections = 0;
+  std::chrono::duration<double, std::milli> tBatched( 0. );
+  std::chrono::duration<double, std::milli> tBaseline( 0. );
+  for ( unsigned int e = 0; nEvents > e; ++e ) {
+    PrSeedingTestEvent::fill( hits, search.geometry(), seedOf( e ), tracksOf( e ), 30 );
+    PrSeedingTestEvent::search( search, hits, context );
+
+    for ( unsigned int part = 0; 2 > part; ++part ) {
+      const PrSeedCandidates& xCandidates = context.halves[part].xCandidates;
+      nXProjections += std::count_if( xCandidates.begin(), xCandidates.end(),
+                                      []( const PrSeedCandidate& track ) { return track.valid(); } );
+
+      PrSeedCandidates baseline;
+      for ( unsigned int r = 0; nRepeat > r; ++r ) {
+        baseline.clear();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        addStereoBaseline( search, hits, part, xCandidates, baseline );
+        tBaseline += std::chrono::steady_clock::now() - start;
+      }
+      for ( unsigned int r = 0; nRepeat > r; ++r ) {
+        state.reset();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        search.addStereoToProjections( hits, part, xCandidates, 0, xCandidates.size(), state );
+        tBatched += std::chrono::steady_clock::now() - start;
+      }
+
+      PrSeedingTestEvent::Tracks expected;
+      PrSeedingTestEvent::Tracks tracks;
+      PrSeedingTestEvent::add( hits, part, baseline, false, expected );
+      PrSeedingTestEvent::add( hits, part, state.trackCandidates, false, tracks );
+      nTracks += expected.size();
+      const unsigned int n = PrSeedingTestEvent::nDifferent( expected, tracks );
+      if ( 0 != n ) {
+        std::printf( "event %u, half %u: %u of %u tracks differ from the baseline, the first one is track %u\n", e, part,
+                     n, (unsigned int)expected.size(), PrSeedingTestEvent::firstDifferent( expected, tracks ) );
+        ++nFailed;
+      }
+    }
+  }
+  std::printf( "%u events, %u x projections, %u tracks: %u halves differ from the baseline\n",
+               nEvents, nXProjections, nTracks, nFailed );
+  std::printf( "time per event: %.3f ms batched, %.3f ms one projection at a time\n",
+               tBatched.count() / ( nEvents * nRepeat ), tBaseline.count() / ( nEvents * nRepeat ) );
+  return 0 == nFailed ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+// Include files
+#include <cmath>
+#include <cstdio>
+
+#include "PrSeedingSearch.h"
+#include "PrSeedingTestEvent.h"
+#include "PrSeedingTier.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingTier and of the tier of the events of PrSeedingSearch:
+//
+// - choose() keeps a tier while its cost of the nominal time is at most the target, at the
+//   boundary itself too, takes the next one just above it, and the last one when none
+//   reaches the target; empty events and a nominal time of 0 take tier 0;
+// - the tier never goes down when the number of hits grows, and each tier is cheaper,
+//   with a smaller TolXSup, fewer parabola seeds and not more cases than the one before;
+// - the search sets the tier of the event from its number of hits, and tier 0 without a
+//   target whatever the tier of the event before; the cheaper tiers find fewer tracks;
+// - counted as PrSeedingXLayers counts EventsInTier0..2, each event is in one tier.
+//
+// Returns 0 on success, 1 if a tier or a count differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  /// Search with the latency target and scale
+  struct Setup {
+    Setup( float target, float scale ) : search( make( target, scale ) ), context( search ) {}
+
+    static PrSeedingSearch make( float target, float scale ) {
+      PrSeedingSearch::Config config;
+      config.latencyTarget = target;
+      config.latencyScale  = scale;
+      PrSeedingSearch search;
+      search.configure( config, PrSeedingSimd::best() );
+      PrSeedingTestEvent::makeGeometry( search.geometry() );
+      return search;
+    }
+
+    PrSeedingSearch               search;
+    PrSeedingSearch::EventContext context;
+  };
+
+  /// Check the tier chosen for nHits, print it if it differs
+  unsigned int check( unsigned int nHits, float scale, float target, unsigned int expected ) {
+    const unsigned int tier = PrSeedingTier::choose( nHits, scale, target );
+    if ( expected == tier ) return 0;
+    std::printf( "%u hits, scale %g, target %.9g: tier %u instead of %u\n", nHits, scale, target, tier, expected );
+    return 1;
+  }
+}
+
+int main() {
+  unsigned int nFailed = 0;
+
+  // -- Boundaries: with 10000 hits the nominal time is the scale, exactly
+  const float scale = 8.f;
+  const float cost1 = PrSeedingTier::get( 1 ).cost * scale;
+  nFailed += check( 10000, scale, scale, 0 );
+  nFailed += check( 10000, scale, std::nextafter( scale, 0.f ), 1 );
+  nFailed += check( 10000, scale, cost1, 1 );
+  nFailed += check( 10000, scale, std::nextafter( cost1, 0.f ), 2 );
+  nFailed += check( 10000, scale, 1.e-6f, 2 );
+  nFailed += check( 10000, scale, 0.f, 2 );
+  nFailed += check( 0, scale, 0.f, 0 );
+  nFailed += check( 1000000, 0.f, 0.f, 0 );
+  nFailed += check( 20000, scale, 8.f * scale, 0 );
+  nFailed += check( 20000, scale, std::nextafter( 8.f * scale, 0.f ), 1 );
+
+  // -- Monotonic in the number of hits, cheaper from tier to tier
+  unsigned int tierBefore = 0;
+  for ( unsigned int nHits = 0; 40000 > nHits; nHits += 7 ) {
+    const unsigned int tier = PrSeedingTier::choose( nHits, 50.f, 100.f );
+    if ( tier < tierBefore ) {
+      std::printf( "%u hits: tier %u after tier %u\n", nHits, tier, tierBefore );
+      ++nFailed;
+    }
+    tierBefore = tier;
+  }
+  if ( 2 != tierBefore ) ++nFailed;
+  for ( unsigned int tier = 1; PrSeedingTier::nTiers > tier; ++tier ) {
+    const PrSeedingTier& cheaper = PrSeedingTier::get( tier );
+    const PrSeedingTier& before  = PrSeedingTier::get( tier - 1 );
+    if ( !( cheaper.cost < before.cost ) || cheaper.tolXSup( 1.f ) > before.tolXSup( 1.f ) ||
+         cheaper.maxParabolaSeedHits( 100 ) > before.maxParabolaSeedHits( 100 ) || cheaper.nCases > before.nCases ) {
+      std::printf( "tier %u is not cheaper than tier %u\n", tier, tier - 1 );
+      ++nFailed;
+    }
+  }
+  if ( 4 != PrSeedingTier::get( 0 ).maxParabolaSeedHits( 4 ) || 2 != PrSeedingTier::get( 1 ).maxParabolaSeedHits( 4 ) ||
+       1 != PrSeedingTier::get( 2 ).maxParabolaSeedHits( 1 ) ) {
+    std::printf( "wrong number of parabola seeds\n" );
+    ++nFailed;
+  }
+
+  // -- The tier of the search, with a scale which puts the event at the given multiple of the target
+  PrSeedingHitStore hits;
+  hits.setBucketWidth( PrSeedingSearch::Config().xBucketWidth );
+  PrSeedingTestEvent::fill( hits, Setup::make( 0., 50. ).geometry(), 20140801, 300, 30 );
+  const float target  = 10.f;
+  const float nominal = std::pow( 1.e-4f * hits.size(), 3.f );
+  const float factors[4]             = { 0.9f, 1.2f, 1.8f, 100.f };
+  const unsigned int expectedTier[4] = { 0, 1, 2, 2 };
+  unsigned int nTracksBefore = ~0u;
+  for ( unsigned int f = 0; 4 > f; ++f ) {
+    Setup setup( target, factors[f] * target / nominal );
+    const unsigned int nTracks = PrSeedingTestEvent::search( setup.search, hits, setup.context ).size();
+    std::printf( "%u hits at %g times the target: tier %u, %u tracks\n", hits.size(), factors[f], setup.context.tier,
+                 nTracks );
+    if ( expectedTier[f] != setup.context.tier ) ++nFailed;
+    if ( setup.context.tier != PrSeedingTier::choose( hits.size(), setup.search.config().latencyScale, target ) ) ++nFailed;
+    if ( nTracks > nTracksBefore || ( 2 == f && nTracks == nTracksBefore ) ) ++nFailed;
+    nTracksBefore = nTracks;
+
+    // -- No target: tier 0 in the same context
+    Setup none( 0., factors[f] * target / nominal );
+    PrSeedingTestEvent::search( none.search, hits, setup.context );
+    if ( 0 != setup.context.tier ) {
+      std::printf( "tier %u without a target\n", setup.context.tier );
+      ++nFailed;
+    }
+  }
+
+  // -- Events per tier, over events of growing multiplicity
+  Setup counted( target, 50.f * target / nominal );
+  unsigned int eventsInTier[PrSeedingTier::nTiers] = {};
+  const unsigned int nEvents = 8;
+  for ( unsigned int e = 0; nEvents > e; ++e ) {
+    PrSeedingTestEvent::fill( hits, counted.search.geometry(), 20140802 + e, 20 + 60 * e, 10 );
+    PrSeedingTestEvent::search( counted.search, hits, counted.context );
+    if ( counted.context.tier != PrSeedingTier::choose( hits.size(), counted.search.config().latencyScale, target ) ) {
+      ++nFailed;
+    }
+    for ( unsigned int tier = 0; PrSeedingTier::nTiers > tier; ++tier ) {
+      eventsInTier[tier] += ( tier == counted.context.tier );
+    }
+  }
+  std::printf( "%u events: %u in tier 0, %u in tier 1, %u in tier 2\n", nEvents, eventsInTier[0], eventsInTier[1],
+               eventsInTier[2] );
+  if ( nEvents != eventsInTier[0] + eventsInTier[1] + eventsInTier[2] ) ++nFailed;
+  for ( unsigned int tier = 0; PrSeedingTier::nTiers > tier; ++tier ) {
+    if ( 0 == eventsInTier[tier] ) ++nFailed;
+  }
+  return 0 == nFailed ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// Include files
+#include <cstdio>
+
+#include "PrSeedingUsedHits.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingUsedHits: the flags around the word boundaries, reset(), and the
+// copy-on-write views: a view reads the flags of its parent until its first write,
+// never changes them, and merge() folds its flags back.
+//
+// Returns 0 on success, 1 if a check fails.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  unsigned int nFailed = 0;
+
+  void check( bool ok, const char* what ) {
+    if ( ok ) return;
+    std::printf( "FAILED: %s\n", what );
+    ++nFailed;
+  }
+
+  /// The hits set in flags, among [0, nHits)
+  unsigned int count( const PrSeedingUsedHits& flags, unsigned int nHits ) {
+    unsigned int n = 0;
+    for ( unsigned int hit = 0; nHits > hit; ++hit ) n += flags.isUsed( hit );
+    return n;
+  }
+}
+
+int main() {
+  const unsigned int nHits = 200;
+
+  PrSeedingUsedHits flags;
+  flags.reset( nHits );
+  check( 0 == count( flags, nHits ), "no hit is used after reset" );
+  flags.setUsed( 0 );
+  flags.setUsed( 63 );
+  flags.setUsed( 64 );
+  flags.setUsed( 199 );
+  check( flags.isUsed( 0 ) && flags.isUsed( 63 ) && flags.isUsed( 64 ) && flags.isUsed( 199 ), "the set hits are used" );
+  check( 4 == count( flags, nHits ), "only the set hits are used" );
+
+  // -- A view reads the flags of its parent and takes its own copy on the first write
+  PrSeedingUsedHits view = flags.view();
+  check( 4 == count( view, nHits ), "a view sees the flags of its parent" );
+  view.setUsed( 100 );
+  check( view.isUsed( 100 ) && view.isUsed( 63 ), "a view sees its own flags and the ones of its parent" );
+  check( !flags.isUsed( 100 ), "a view does not write into its parent" );
+
+  // -- Copies: of an unwritten view it shares the parent, of a written one it is independent
+  PrSeedingUsedHits readOnly = flags.view();
+  PrSeedingUsedHits readOnlyCopy( readOnly );
+  check( 4 == count( readOnlyCopy, nHits ), "the copy of a view sees the flags of the parent" );
+  PrSeedingUsedHits copy( view );
+  copy.setUsed( 101 );
+  check( !view.isUsed( 101 ), "the copy of a written view does not write into it" );
+  check( copy.isUsed( 100 ), "the copy of a written view has its flags" );
+  PrSeedingUsedHits assigned;
+  assigned = view;
+  assigned.setUsed( 102 );
+  check( !view.isUsed( 102 ) && assigned.isUsed( 100 ), "an assigned view is independent" );
+
+  // -- Two views written independently, as by the two halves, then merged
+  PrSeedingUsedHits other = flags.view();
+  other.setUsed( 150 );
+  check( !view.isUsed( 150 ), "the views do not see each other" );
+  flags.merge( readOnly );
+  check( 4 == count( flags, nHits ), "merging an unwritten view changes nothing" );
+  flags.merge( view );
+  flags.merge( other );
+  check( flags.isUsed( 100 ) && flags.isUsed( 150 ), "merge adds the flags of the views" );
+  check( 6 == count( flags, nHits ), "merge adds only the flags of the views" );
+
+  // -- reset() clears everything, also for a different number of hits
+  flags.reset( nHits );
+  check( 0 == count( flags, nHits ), "reset clears the flags" );
+  flags.reset( 64 );
+  flags.setUsed( 63 );
+  check( 1 == count( flags, 64 ), "one word of flags" );
+  flags.reset( 0 );
+  PrSeedingUsedHits empty = flags.view();
+  flags.merge( empty );
+
+  std::printf( "%u checks failed\n", nFailed );
+  return 0 == nFailed ? 0 : 1;
+}
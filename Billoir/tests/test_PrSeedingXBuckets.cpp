@@ -0,0 +1,96 @@
+// Include files
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "PrSeedingXBuckets.h"
+
+//-----------------------------------------------------------------------------
+// Test of PrSeedingXBuckets: lowerBound() must give the position of std::lower_bound
+// for zones of random hits with bin widths from 0.05 to 500 mm, and for the edge cases:
+// no hit, one hit, all hits at the same x, a range of more than maxBins bins, and
+// xMin below the first hit, above the last one, on a hit and on the edge of a bin.
+//
+// Returns 0 on success, 1 if a zone differs.
+//-----------------------------------------------------------------------------
+
+namespace {
+
+  /// Number of queries of xs whose lowerBound() differs from std::lower_bound
+  unsigned int nWrong( const std::vector<float>& x, float width, const std::vector<float>& xs ) {
+    PrSeedingXBuckets buckets;
+    const float* data = x.data();
+    buckets.build( x.size(), [data]( unsigned int i ) { return data[i]; }, width );
+    unsigned int n = 0;
+    for ( std::vector<float>::const_iterator itX = xs.begin(); xs.end() != itX; ++itX ) {
+      const unsigned int ref = std::lower_bound( x.begin(), x.end(), *itX ) - x.begin();
+      if ( ref != buckets.lowerBound( *itX, x.size(), [data]( unsigned int i ) { return data[i]; } ) ) ++n;
+    }
+    return n;
+  }
+
+  /// Queries on the hits, just around them, on the edges of the bins and outside of the zone
+  std::vector<float> queries( std::mt19937& rng, const std::vector<float>& x, float width ) {
+    std::uniform_real_distribution<float> flat( -4000., 4000. );
+    std::vector<float> xs;
+    for ( unsigned int k = 0; 2000 > k; ++k ) xs.push_back( flat( rng ) );
+    for ( std::vector<float>::const_iterator itX = x.begin(); x.end() != itX; ++itX ) {
+      xs.push_back( *itX );
+      xs.push_back( std::nextafter( *itX, -1e9f ) );
+      xs.push_back( std::nextafter( *itX, 1e9f ) );
+    }
+    if ( !x.empty() ) {
+      for ( unsigned int b = 0; 2000 > b; ++b ) {
+        const float edge = x.front() + b * width;
+        xs.push_back( edge );
+        xs.push_back( std::nextafter( edge, -1e9f ) );
+      }
+      xs.push_back( x.front() - 1e6f );
+      xs.push_back( x.back() + 1e6f );
+    }
+    return xs;
+  }
+}
+
+int main() {
+  std::mt19937 rng( 20140703 );
+  const float widths[6] = { 0.05, 0.5, 4., 20., 100., 500. };
+  unsigned int nFailed = 0;
+
+  // -- Zones of random hits, sorted, with some at the same x
+  const unsigned int sizes[5] = { 2, 10, 150, 1000, 5000 };
+  for ( unsigned int iS = 0; 5 > iS; ++iS ) {
+    std::uniform_real_distribution<float> flat( -3000., 3000. );
+    std::vector<float> x;
+    for ( unsigned int i = 0; sizes[iS] > i; ++i ) x.push_back( flat( rng ) );
+    for ( unsigned int i = 0; sizes[iS] / 10 > i; ++i ) x[rng() % x.size()] = x[rng() % x.size()];
+    std::sort( x.begin(), x.end() );
+    for ( unsigned int iW = 0; 6 > iW; ++iW ) {
+      const unsigned int n = nWrong( x, widths[iW], queries( rng, x, widths[iW] ) );
+      std::printf( "%5u hits, width %6.2f: %u lookups differ from std::lower_bound\n", sizes[iS], widths[iW], n );
+      if ( 0 != n ) ++nFailed;
+    }
+  }
+
+  // -- Edge cases
+  struct Case {
+    const char*        name;
+    std::vector<float> x;
+    float              width;
+  };
+  std::vector<Case> cases;
+  cases.push_back( Case{ "no hit", std::vector<float>(), 4. } );
+  cases.push_back( Case{ "one hit", std::vector<float>( 1, 12.5 ), 4. } );
+  cases.push_back( Case{ "same x", std::vector<float>( 50, -7.25 ), 4. } );
+  std::vector<float> wide;
+  for ( unsigned int i = 0; 100 > i; ++i ) wide.push_back( -3000.f + 60.f * i );
+  cases.push_back( Case{ "beyond maxBins", wide, 0.01 } );
+  for ( std::vector<Case>::const_iterator itC = cases.begin(); cases.end() != itC; ++itC ) {
+    const unsigned int n = nWrong( (*itC).x, (*itC).width, queries( rng, (*itC).x, (*itC).width ) );
+    std::printf( "%-16s: %u lookups differ from std::lower_bound\n", (*itC).name, n );
+    if ( 0 != n ) ++nFailed;
+  }
+  return 0 == nFailed ? 0 : 1;
+}